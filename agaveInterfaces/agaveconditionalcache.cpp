@@ -0,0 +1,145 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agaveconditionalcache.h"
+
+AgaveConditionalCache::AgaveConditionalCache()
+{
+
+}
+
+void AgaveConditionalCache::setMaxEntries(int newMax)
+{
+    maxEntries = newMax;
+    if ((maxEntries > 0) && (conditionalEntries.size() > maxEntries))
+    {
+        clear();
+    }
+}
+
+void AgaveConditionalCache::addValidators(QNetworkRequest * theRequest)
+{
+    auto itr = conditionalEntries.constFind(getEntryKey(*theRequest));
+    if (itr == conditionalEntries.constEnd()) return;
+
+    if (!itr->eTag.isEmpty())
+    {
+        theRequest->setRawHeader("If-None-Match", itr->eTag);
+    }
+    if (!itr->lastModified.isEmpty())
+    {
+        theRequest->setRawHeader("If-Modified-Since", itr->lastModified);
+    }
+}
+
+void AgaveConditionalCache::storeListing(QNetworkReply * theReply, FileListing newListing)
+{
+    ConditionalEntry newEntry;
+    if (!readValidators(theReply, &newEntry)) return;
+    newEntry.listing = newListing;
+    storeEntry(getEntryKey(theReply->request()), newEntry);
+}
+
+void AgaveConditionalCache::storeJobDetails(QNetworkReply * theReply, RemoteJobData newJobData)
+{
+    ConditionalEntry newEntry;
+    if (!readValidators(theReply, &newEntry)) return;
+    newEntry.jobData = newJobData;
+    storeEntry(getEntryKey(theReply->request()), newEntry);
+}
+
+bool AgaveConditionalCache::lookupListing(QNetworkReply * theReply, FileListing * foundListing)
+{
+    auto itr = conditionalEntries.constFind(getEntryKey(theReply->request()));
+    if (itr == conditionalEntries.constEnd()) return false;
+
+    notModifiedCount++;
+    *foundListing = itr->listing;
+    return true;
+}
+
+bool AgaveConditionalCache::lookupJobDetails(QNetworkReply * theReply, RemoteJobData * foundJobData)
+{
+    auto itr = conditionalEntries.constFind(getEntryKey(theReply->request()));
+    if (itr == conditionalEntries.constEnd()) return false;
+
+    notModifiedCount++;
+    *foundJobData = itr->jobData;
+    return true;
+}
+
+bool AgaveConditionalCache::isNotModified(QNetworkReply * theReply)
+{
+    return (theReply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 304);
+}
+
+void AgaveConditionalCache::clear()
+{
+    conditionalEntries.clear();
+}
+
+int AgaveConditionalCache::getNotModifiedCount()
+{
+    return notModifiedCount;
+}
+
+bool AgaveConditionalCache::readValidators(QNetworkReply * theReply, ConditionalEntry * newEntry)
+{
+    newEntry->eTag = theReply->rawHeader("ETag");
+    newEntry->lastModified = theReply->rawHeader("Last-Modified");
+
+    if (newEntry->eTag.isEmpty() && newEntry->lastModified.isEmpty())
+    {
+        //The resource may have had validators before, which no longer apply
+        conditionalEntries.remove(getEntryKey(theReply->request()));
+        return false;
+    }
+    return true;
+}
+
+void AgaveConditionalCache::storeEntry(QString theKey, const ConditionalEntry &newEntry)
+{
+    if ((maxEntries > 0) && (conditionalEntries.size() >= maxEntries) && !conditionalEntries.contains(theKey))
+    {
+        //Polled URLs are stored again on their next reply, so any entry can go
+        conditionalEntries.erase(conditionalEntries.begin());
+    }
+    conditionalEntries.insert(theKey, newEntry);
+}
+
+QString AgaveConditionalCache::getEntryKey(const QNetworkRequest &theRequest)
+{
+    return theRequest.url().toString(QUrl::FullyEncoded);
+}
@@ -0,0 +1,93 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVECONDITIONALCACHE_H
+#define AGAVECONDITIONALCACHE_H
+
+#include "../filelisting.h"
+#include "../remotejobdata.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+//Validators (ETag, Last-Modified) and the parsed result of earlier GET replies, keyed by request URL
+//Requests for a known URL are sent as conditional requests, and a 304 (not modified)
+//reply is answered with the stored result, without reading any JSON.
+class AgaveConditionalCache
+{
+public:
+    AgaveConditionalCache();
+
+    void setMaxEntries(int newMax);
+
+    //Adds If-None-Match/If-Modified-Since, if there is a stored result for this URL
+    void addValidators(QNetworkRequest * theRequest);
+
+    //Nothing is stored if the reply has no validators
+    void storeListing(QNetworkReply * theReply, FileListing newListing);
+    void storeJobDetails(QNetworkReply * theReply, RemoteJobData newJobData);
+
+    //For a 304 reply, gives the result stored for its URL
+    bool lookupListing(QNetworkReply * theReply, FileListing * foundListing);
+    bool lookupJobDetails(QNetworkReply * theReply, RemoteJobData * foundJobData);
+
+    static bool isNotModified(QNetworkReply * theReply);
+
+    void clear();
+    int getNotModifiedCount();
+
+private:
+    struct ConditionalEntry
+    {
+        QByteArray eTag;
+        QByteArray lastModified;
+        FileListing listing;
+        RemoteJobData jobData;
+    };
+
+    bool readValidators(QNetworkReply * theReply, ConditionalEntry * newEntry);
+    void storeEntry(QString theKey, const ConditionalEntry &newEntry);
+
+    static QString getEntryKey(const QNetworkRequest &theRequest);
+
+    QHash<QString, ConditionalEntry> conditionalEntries;
+    int maxEntries = 512;
+    int notModifiedCount = 0;
+};
+
+#endif // AGAVECONDITIONALCACHE_H
@@ -0,0 +1,160 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavefilefollower.h"
+#include "agavehandler.h"
+#include "agavelogging.h"
+
+AgaveFileFollower::AgaveFileFollower(AgaveHandler * theManager, QString remoteName) : QObject((QObject *)theManager)
+{
+    myManager = theManager;
+    myRemoteName = remoteName;
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollFile()));
+}
+
+void AgaveFileFollower::startFollowing(qint64 startOffset)
+{
+    nextOffset = qMax(startOffset, (qint64) 0);
+    following = true;
+    currentInterval = minInterval;
+    if (!requestPending)
+    {
+        pollTimer.start(0);
+    }
+}
+
+void AgaveFileFollower::stopFollowing()
+{
+    following = false;
+    pollTimer.stop();
+}
+
+bool AgaveFileFollower::isFollowing()
+{
+    return following;
+}
+
+void AgaveFileFollower::setPollIntervals(int minMsecs, int maxMsecs)
+{
+    minInterval = qMax(minMsecs, 100);
+    maxInterval = qMax(maxMsecs, minInterval);
+    currentInterval = qBound(minInterval, currentInterval, maxInterval);
+}
+
+QString AgaveFileFollower::getRemoteName()
+{
+    return myRemoteName;
+}
+
+qint64 AgaveFileFollower::getOffset()
+{
+    return nextOffset;
+}
+
+void AgaveFileFollower::pollFile()
+{
+    if (!following || requestPending) return;
+
+    RemoteDataReply * rangeReply = myManager->readRemoteRange(myRemoteName, nextOffset);
+    if (rangeReply == NULL)
+    {
+        emit followError(myRemoteName, RequestState::NO_CONNECT);
+        scheduleNextPoll(false);
+        return;
+    }
+    requestPending = true;
+    QObject::connect(rangeReply, SIGNAL(haveRangeReply(RequestState,QByteArray,qint64,qint64)),
+                     this, SLOT(gotRange(RequestState,QByteArray,qint64,qint64)));
+}
+
+void AgaveFileFollower::gotRange(RequestState replyState, QByteArray rangeData, qint64 rangeOffset, qint64 totalSize)
+{
+    requestPending = false;
+    if (!following) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        emit followError(myRemoteName, replyState);
+        scheduleNextPoll(false);
+        return;
+    }
+
+    if ((totalSize >= 0) && (totalSize < nextOffset))
+    {
+        qCDebug(agaveReplies, "Followed file %s was truncated", qPrintable(myRemoteName));
+        nextOffset = 0;
+        emit fileTruncated(myRemoteName);
+        currentInterval = minInterval;
+        pollTimer.start(0);
+        return;
+    }
+
+    //A server which ignores ranges sends the whole file, of which only the new part is wanted
+    if ((rangeOffset < nextOffset) && (rangeOffset + rangeData.size() > nextOffset))
+    {
+        rangeData = rangeData.mid(nextOffset - rangeOffset);
+        rangeOffset = nextOffset;
+    }
+    else if (rangeOffset != nextOffset)
+    {
+        rangeData.clear();
+    }
+
+    bool gotNewData = !rangeData.isEmpty();
+    if (gotNewData)
+    {
+        nextOffset += rangeData.size();
+        emit newFileData(myRemoteName, rangeData, rangeOffset);
+    }
+    scheduleNextPoll(gotNewData);
+}
+
+void AgaveFileFollower::scheduleNextPoll(bool gotNewData)
+{
+    if (!following) return;
+
+    //Poll faster while the file grows, slower while it does not
+    if (gotNewData)
+    {
+        currentInterval = qMax(currentInterval / 2, minInterval);
+    }
+    else
+    {
+        currentInterval = qMin(currentInterval + currentInterval / 2, maxInterval);
+    }
+    pollTimer.start(currentInterval);
+}
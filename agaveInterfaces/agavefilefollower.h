@@ -0,0 +1,92 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEFILEFOLLOWER_H
+#define AGAVEFILEFOLLOWER_H
+
+#include "../remotedatainterface.h"
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QTimer>
+
+class AgaveHandler;
+
+//Follows a growing remote file, such as a job's log, like tail -f
+//Each poll asks only for the bytes after the last offset, and new bytes arrive through newFileData.
+//The poll interval shrinks while the file grows and backs off while it does not.
+//If the file becomes shorter than the offset, it is taken as replaced and read again from the start.
+class AgaveFileFollower : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveFileFollower(AgaveHandler * theManager, QString remoteName);
+
+    void startFollowing(qint64 startOffset = 0);
+    void stopFollowing();
+    bool isFollowing();
+
+    void setPollIntervals(int minMsecs, int maxMsecs);
+
+    QString getRemoteName();
+    qint64 getOffset();
+
+signals:
+    void newFileData(QString remoteName, QByteArray newData, qint64 dataOffset);
+    void fileTruncated(QString remoteName);
+    void followError(QString remoteName, RequestState replyState);
+
+private slots:
+    void pollFile();
+    void gotRange(RequestState replyState, QByteArray rangeData, qint64 rangeOffset, qint64 totalSize);
+
+private:
+    void scheduleNextPoll(bool gotNewData);
+
+    AgaveHandler * myManager = NULL;
+    QString myRemoteName;
+
+    QTimer pollTimer;
+    qint64 nextOffset = 0;
+    bool following = false;
+    bool requestPending = false;
+
+    int minInterval = 1000;
+    int maxInterval = 30000;
+    int currentInterval = 1000;
+};
+
+#endif // AGAVEFILEFOLLOWER_H
@@ -0,0 +1,447 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavefilesearchindex.h"
+#include "agavelistingcache.h"
+
+#include <algorithm>
+#include <iterator>
+
+AgaveFileSearchIndex::AgaveFileSearchIndex()
+{
+
+}
+
+void AgaveFileSearchIndex::setEnabled(bool enable)
+{
+    indexEnabled = enable;
+    if (!indexEnabled)
+    {
+        clear();
+    }
+}
+
+bool AgaveFileSearchIndex::isEnabled()
+{
+    return indexEnabled;
+}
+
+void AgaveFileSearchIndex::indexListing(QString dirPath, const FileListing &dirListing)
+{
+    if (!indexEnabled) return;
+
+    QString dirKey = AgaveListingCache::getCacheKey(dirPath);
+    QHash<QString, FileType> listedTypes;
+    listedTypes.reserve(dirListing.size());
+    for (auto itr = dirListing.constBegin(); itr != dirListing.constEnd(); ++itr)
+    {
+        listedTypes.insert(AgaveListingCache::getCacheKey((*itr).getFullPath()), (*itr).getFileType());
+    }
+    //Agave lists the folder itself as "."
+    listedTypes.remove(dirKey);
+
+    //What is no longer there, or is no longer a folder, goes with everything under it
+    QStringList removedPaths;
+    const QVector<int> oldContents = folderContents.value(dirKey);
+    for (int entryID : oldContents)
+    {
+        const FileMetaData &oldFile = indexEntries.at(entryID).fileData;
+        QString oldKey = oldFile.getFullPath();
+        auto typeItr = listedTypes.constFind(oldKey);
+        if ((typeItr == listedTypes.constEnd()) ||
+                ((oldFile.getFileType() == FileType::DIR) && (*typeItr != FileType::DIR)))
+        {
+            removedPaths.append(oldKey);
+        }
+    }
+    for (const QString &oldKey : removedPaths)
+    {
+        removeSubtree(oldKey);
+    }
+
+    for (auto itr = dirListing.constBegin(); itr != dirListing.constEnd(); ++itr)
+    {
+        FileMetaData aFile = (*itr).toFileMetaData();
+        if (AgaveListingCache::getCacheKey(aFile.getFullPath()) == dirKey) continue;
+        addEntry(aFile);
+    }
+    compactIfNeeded();
+}
+
+void AgaveFileSearchIndex::insertFile(const FileMetaData &newFile)
+{
+    if (!indexEnabled) return;
+    addEntry(newFile);
+}
+
+void AgaveFileSearchIndex::removeTree(QString fullPath)
+{
+    if (!indexEnabled) return;
+
+    removeSubtree(fullPath);
+    compactIfNeeded();
+}
+
+void AgaveFileSearchIndex::moveTree(QString fromPath, const FileMetaData &newFile)
+{
+    if (!indexEnabled) return;
+
+    QString fromKey = AgaveListingCache::getCacheKey(fromPath);
+    QString toKey = AgaveListingCache::getCacheKey(newFile.getFullPath());
+    if (fromKey.isEmpty() || (fromKey == toKey)) return;
+
+    //A move may replace what was at the destination
+    removeSubtree(toKey);
+
+    //Names under the moved path do not change, so only their paths are updated
+    QList<QString> foldersToMove;
+    foldersToMove.append(fromKey);
+    QHash<QString, QVector<int> > movedContents;
+    while (!foldersToMove.isEmpty())
+    {
+        QString oldFolder = foldersToMove.takeFirst();
+        QVector<int> folderIDs = folderContents.take(oldFolder);
+        if (folderIDs.isEmpty()) continue;
+
+        QString newFolder = toKey + oldFolder.mid(fromKey.size());
+        for (int entryID : folderIDs)
+        {
+            FileMetaData &movedFile = indexEntries[entryID].fileData;
+            QString oldKey = movedFile.getFullPath();
+            pathToID.remove(oldKey);
+            movedFile.setFullFilePath(newFolder + "/" + movedFile.getFileName());
+            pathToID.insert(movedFile.getFullPath(), entryID);
+            if (movedFile.getFileType() == FileType::DIR)
+            {
+                foldersToMove.append(oldKey);
+            }
+        }
+        movedContents.insert(newFolder, folderIDs);
+    }
+    for (auto itr = movedContents.constBegin(); itr != movedContents.constEnd(); itr++)
+    {
+        folderContents.insert(itr.key(), itr.value());
+    }
+
+    //The moved path itself may have a new name
+    int rootID = pathToID.value(fromKey, -1);
+    if (rootID >= 0)
+    {
+        removeEntry(rootID);
+    }
+    addEntry(newFile);
+    compactIfNeeded();
+}
+
+void AgaveFileSearchIndex::clear()
+{
+    indexEntries.clear();
+    pathToID.clear();
+    trigramLists.clear();
+    folderContents.clear();
+    liveCount = 0;
+}
+
+QList<FileMetaData> AgaveFileSearchIndex::findSubstring(QString searchText, int maxResults)
+{
+    return findSubstringUnder(QString(), searchText, maxResults);
+}
+
+QList<FileMetaData> AgaveFileSearchIndex::findGlob(QString wildcardPattern, int maxResults)
+{
+    return findGlobUnder(QString(), wildcardPattern, maxResults);
+}
+
+QList<FileMetaData> AgaveFileSearchIndex::findSubstringUnder(QString rootPath, QString searchText, int maxResults)
+{
+    //Text with a '/' may match any folder in the path, so its trigrams need not be in the name
+    bool matchPath = searchText.contains('/');
+    QStringList literalParts;
+    if (!matchPath)
+    {
+        literalParts.append(searchText);
+    }
+    return runQuery(rootPath, literalParts, matchPath, NULL, searchText, maxResults);
+}
+
+QList<FileMetaData> AgaveFileSearchIndex::findGlobUnder(QString rootPath, QString wildcardPattern, int maxResults)
+{
+    QRegularExpression matchPattern(QRegularExpression::anchoredPattern(QRegularExpression::wildcardToRegularExpression(wildcardPattern)),
+                                    QRegularExpression::CaseInsensitiveOption);
+    bool matchPath = wildcardPattern.contains('/');
+
+    //Literal text between wildcards must be in the name. For a path pattern, only the literal
+    //text at its end is sure to be in the name, as '*' may also match across folders.
+    QString nameText = wildcardPattern;
+    if (matchPath)
+    {
+        int lastSpecial = -1;
+        for (int i = 0; i < wildcardPattern.size(); i++)
+        {
+            QChar aChar = wildcardPattern.at(i);
+            if ((aChar == '/') || (aChar == '*') || (aChar == '?') || (aChar == ']')) lastSpecial = i;
+        }
+        nameText = wildcardPattern.mid(lastSpecial + 1);
+    }
+
+    QStringList literalParts;
+    QString currentPart;
+    bool inBracket = false;
+    for (QChar aChar : nameText)
+    {
+        if (inBracket)
+        {
+            if (aChar == ']') inBracket = false;
+            continue;
+        }
+        if ((aChar == '*') || (aChar == '?') || (aChar == '['))
+        {
+            literalParts.append(currentPart);
+            currentPart.clear();
+            inBracket = (aChar == '[');
+        }
+        else
+        {
+            currentPart.append(aChar);
+        }
+    }
+    literalParts.append(currentPart);
+
+    return runQuery(rootPath, literalParts, matchPath, &matchPattern, QString(), maxResults);
+}
+
+int AgaveFileSearchIndex::getEntryCount()
+{
+    return liveCount;
+}
+
+void AgaveFileSearchIndex::removeSubtree(QString fullPath)
+{
+    QString rootKey = AgaveListingCache::getCacheKey(fullPath);
+    QList<QString> foldersToClear;
+    foldersToClear.append(rootKey);
+    while (!foldersToClear.isEmpty())
+    {
+        const QVector<int> folderIDs = folderContents.take(foldersToClear.takeFirst());
+        for (int entryID : folderIDs)
+        {
+            if (indexEntries.at(entryID).fileData.getFileType() == FileType::DIR)
+            {
+                foldersToClear.append(indexEntries.at(entryID).fileData.getFullPath());
+            }
+            removeEntry(entryID);
+        }
+    }
+
+    int rootID = pathToID.value(rootKey, -1);
+    if (rootID >= 0)
+    {
+        removeEntry(rootID);
+    }
+}
+
+int AgaveFileSearchIndex::addEntry(const FileMetaData &newFile)
+{
+    QString entryKey = AgaveListingCache::getCacheKey(newFile.getFullPath());
+    if (entryKey.isEmpty()) return -1;
+
+    int entryID = pathToID.value(entryKey, -1);
+    if (entryID >= 0)
+    {
+        //Same path, so the same name and trigrams
+        FileType oldType = indexEntries.at(entryID).fileData.getFileType();
+        indexEntries[entryID].fileData = newFile;
+        indexEntries[entryID].fileData.setFullFilePath(entryKey);
+        if ((oldType == FileType::DIR) && (newFile.getFileType() != FileType::DIR))
+        {
+            QVector<int> oldContents = folderContents.value(entryKey);
+            for (int childID : oldContents)
+            {
+                removeSubtree(indexEntries.at(childID).fileData.getFullPath());
+            }
+        }
+        return entryID;
+    }
+
+    entryID = indexEntries.size();
+    IndexEntry newEntry;
+    newEntry.fileData = newFile;
+    newEntry.fileData.setFullFilePath(entryKey);
+    newEntry.live = true;
+    indexEntries.append(newEntry);
+    pathToID.insert(entryKey, entryID);
+    folderContents[AgaveListingCache::getParentKey(entryKey)].append(entryID);
+    liveCount++;
+
+    QString lowerName = newEntry.fileData.getFileName().toLower();
+    const QChar * nameData = lowerName.constData();
+    for (int i = 0; i + 3 <= lowerName.size(); i++)
+    {
+        QVector<int> &trigramList = trigramLists[getTrigramKey(nameData + i)];
+        //A trigram repeated in one name is listed once
+        if (trigramList.isEmpty() || (trigramList.last() != entryID))
+        {
+            trigramList.append(entryID);
+        }
+    }
+    return entryID;
+}
+
+void AgaveFileSearchIndex::removeEntry(int entryID)
+{
+    IndexEntry &theEntry = indexEntries[entryID];
+    if (!theEntry.live) return;
+
+    theEntry.live = false;
+    QString entryKey = theEntry.fileData.getFullPath();
+    pathToID.remove(entryKey);
+    auto folderItr = folderContents.find(AgaveListingCache::getParentKey(entryKey));
+    if (folderItr != folderContents.end())
+    {
+        folderItr->removeOne(entryID);
+    }
+    liveCount--;
+}
+
+void AgaveFileSearchIndex::compactIfNeeded()
+{
+    //Rebuilt once dead entries outnumber live ones
+    int deadCount = indexEntries.size() - liveCount;
+    if ((deadCount < 1024) || (deadCount <= liveCount)) return;
+
+    int keptCount = liveCount;
+    QVector<IndexEntry> oldEntries;
+    oldEntries.swap(indexEntries);
+    clear();
+    indexEntries.reserve(keptCount);
+    for (const IndexEntry &anEntry : oldEntries)
+    {
+        if (anEntry.live)
+        {
+            addEntry(anEntry.fileData);
+        }
+    }
+}
+
+QList<FileMetaData> AgaveFileSearchIndex::runQuery(QString rootPath, const QStringList &literalParts, bool matchPath,
+                                                   const QRegularExpression * matchPattern, const QString &matchText, int maxResults)
+{
+    QList<FileMetaData> ret;
+    if (!indexEnabled) return ret;
+
+    QString rootKey = AgaveListingCache::getCacheKey(rootPath);
+    bool useAll = false;
+    QVector<int> candidateIDs = findCandidates(literalParts, &useAll);
+    int candidateCount = useAll ? indexEntries.size() : candidateIDs.size();
+
+    for (int i = 0; i < candidateCount; i++)
+    {
+        if ((maxResults >= 0) && (ret.size() >= maxResults)) break;
+
+        const IndexEntry &anEntry = indexEntries.at(useAll ? i : candidateIDs.at(i));
+        if (!anEntry.live) continue;
+
+        QString entryPath = anEntry.fileData.getFullPath();
+        if (!rootKey.isEmpty() && !isUnder(entryPath, rootKey)) continue;
+
+        QString toMatch = matchPath ? entryPath : anEntry.fileData.getFileName();
+        bool isMatch = (matchPattern != NULL) ? matchPattern->match(toMatch).hasMatch() :
+                                                toMatch.contains(matchText, Qt::CaseInsensitive);
+        if (isMatch)
+        {
+            ret.append(anEntry.fileData);
+        }
+    }
+    return ret;
+}
+
+QVector<int> AgaveFileSearchIndex::findCandidates(const QStringList &literalParts, bool * useAll)
+{
+    QList<const QVector<int> *> neededLists;
+    for (const QString &aPart : literalParts)
+    {
+        QString lowerPart = aPart.toLower();
+        const QChar * partData = lowerPart.constData();
+        for (int i = 0; i + 3 <= lowerPart.size(); i++)
+        {
+            auto listItr = trigramLists.constFind(getTrigramKey(partData + i));
+            if (listItr == trigramLists.constEnd())
+            {
+                *useAll = false;
+                return QVector<int>();
+            }
+            neededLists.append(&(*listItr));
+        }
+    }
+
+    //Text too short for a trigram narrows nothing
+    if (neededLists.isEmpty())
+    {
+        *useAll = true;
+        return QVector<int>();
+    }
+    *useAll = false;
+
+    //Shortest first, so the intersection shrinks quickly
+    std::sort(neededLists.begin(), neededLists.end(), [](const QVector<int> * listA, const QVector<int> * listB)
+    {
+        return listA->size() < listB->size();
+    });
+
+    QVector<int> ret = *(neededLists.first());
+    for (int i = 1; (i < neededLists.size()) && !ret.isEmpty(); i++)
+    {
+        ret = intersectSorted(ret, *(neededLists.at(i)));
+    }
+    return ret;
+}
+
+quint64 AgaveFileSearchIndex::getTrigramKey(const QChar * threeChars)
+{
+    return ((quint64) threeChars[0].unicode() << 32) | ((quint64) threeChars[1].unicode() << 16) | (quint64) threeChars[2].unicode();
+}
+
+QVector<int> AgaveFileSearchIndex::intersectSorted(const QVector<int> &listA, const QVector<int> &listB)
+{
+    QVector<int> ret;
+    ret.reserve(qMin(listA.size(), listB.size()));
+    std::set_intersection(listA.constBegin(), listA.constEnd(), listB.constBegin(), listB.constEnd(), std::back_inserter(ret));
+    return ret;
+}
+
+bool AgaveFileSearchIndex::isUnder(const QString &fullPath, const QString &rootKey)
+{
+    return (fullPath.size() > rootKey.size()) && fullPath.startsWith(rootKey) && (fullPath.at(rootKey.size()) == '/');
+}
@@ -0,0 +1,113 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEFILESEARCHINDEX_H
+#define AGAVEFILESEARCHINDEX_H
+
+#include "../filemetadata.h"
+#include "../filelisting.h"
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QRegularExpression>
+
+//Searchable index of every file and folder seen in a listing, keyed by canonical path ("/a/b")
+//Names are indexed by trigram (case-insensitive), so a query only checks the entries holding
+//every trigram of its literal text. Queries do not use the network, and only find what has been listed.
+//Entries removed are marked dead and left in the trigram lists until enough of them pile up
+//for the index to be rebuilt.
+class AgaveFileSearchIndex
+{
+public:
+    AgaveFileSearchIndex();
+
+    void setEnabled(bool enable);
+    bool isEnabled();
+
+    //Replaces what is known of the folder's contents. Subfolders no longer listed are dropped with their contents.
+    void indexListing(QString dirPath, const FileListing &dirListing);
+    void insertFile(const FileMetaData &newFile);
+    //Drops the path and everything under it
+    void removeTree(QString fullPath);
+    //Moves the path, and what is known under it, to the new file's path
+    void moveTree(QString fromPath, const FileMetaData &newFile);
+    void clear();
+
+    //Entries whose name contains the text, or whose path does if the text contains a '/'
+    QList<FileMetaData> findSubstring(QString searchText, int maxResults = -1);
+    //Entries whose name matches the wildcard pattern, or whose path does if the pattern contains a '/'
+    QList<FileMetaData> findGlob(QString wildcardPattern, int maxResults = -1);
+    //Either search, limited to paths under rootPath
+    QList<FileMetaData> findSubstringUnder(QString rootPath, QString searchText, int maxResults = -1);
+    QList<FileMetaData> findGlobUnder(QString rootPath, QString wildcardPattern, int maxResults = -1);
+
+    int getEntryCount();
+
+private:
+    struct IndexEntry
+    {
+        FileMetaData fileData;
+        bool live;
+    };
+
+    //As removeTree, without compacting, so entry IDs held by the caller stay valid
+    void removeSubtree(QString fullPath);
+    int addEntry(const FileMetaData &newFile);
+    void removeEntry(int entryID);
+    void compactIfNeeded();
+
+    QList<FileMetaData> runQuery(QString rootPath, const QStringList &literalParts, bool matchPath,
+                                 const QRegularExpression * matchPattern, const QString &matchText, int maxResults);
+    QVector<int> findCandidates(const QStringList &literalParts, bool * useAll);
+
+    static quint64 getTrigramKey(const QChar * threeChars);
+    static QVector<int> intersectSorted(const QVector<int> &listA, const QVector<int> &listB);
+    static bool isUnder(const QString &fullPath, const QString &rootKey);
+
+    bool indexEnabled = false;
+
+    QVector<IndexEntry> indexEntries;
+    QHash<QString, int> pathToID;
+    //IDs in each trigram list are in increasing order
+    QHash<quint64, QVector<int> > trigramLists;
+    QHash<QString, QVector<int> > folderContents;
+
+    int liveCount = 0;
+};
+
+#endif // AGAVEFILESEARCHINDEX_H
@@ -0,0 +1,431 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavefiletreemodel.h"
+#include "agavehandler.h"
+#include "agavelistingcache.h"
+
+#include <algorithm>
+
+AgaveFileTreeModel::AgaveFileTreeModel(AgaveHandler * theManager, QObject * parent) : QAbstractItemModel(parent)
+{
+    myManager = theManager;
+    QObject::connect(myManager, SIGNAL(remoteListingChanged(QString,FileListing)),
+                     this, SLOT(remoteListingChanged(QString,FileListing)));
+    QObject::connect(myManager, SIGNAL(remoteListingInvalidated(QString)),
+                     this, SLOT(remoteListingInvalidated(QString)));
+}
+
+AgaveFileTreeModel::~AgaveFileTreeModel()
+{
+    if (rootNode != NULL)
+    {
+        deleteNode(rootNode);
+    }
+}
+
+void AgaveFileTreeModel::setRootPath(QString rootPath)
+{
+    beginResetModel();
+    if (rootNode != NULL)
+    {
+        deleteNode(rootNode);
+    }
+    pathToNode.clear();
+    //Listings still in flight are for the old tree
+    inFlightListings.clear();
+
+    rootKey = AgaveListingCache::getCacheKey(rootPath);
+    if (rootKey.isEmpty())
+    {
+        rootKey = QString("/%1").arg(myManager->getUserName());
+    }
+
+    FileMetaData rootData;
+    rootData.setFullFilePath(rootKey);
+    rootData.setType(FileType::DIR);
+    rootNode = newNode(rootData, NULL);
+    endResetModel();
+}
+
+QString AgaveFileTreeModel::getRootPath()
+{
+    return rootKey;
+}
+
+FileMetaData AgaveFileTreeModel::getFileData(const QModelIndex &index) const
+{
+    FileTreeNode * theNode = nodeFromIndex(index);
+    if (theNode == NULL) return FileMetaData();
+    return theNode->fileData;
+}
+
+QModelIndex AgaveFileTreeModel::getIndexOfPath(QString fullPath)
+{
+    FileTreeNode * theNode = pathToNode.value(AgaveListingCache::getCacheKey(fullPath), NULL);
+    if ((theNode == NULL) || (theNode == rootNode)) return QModelIndex();
+    return indexOfNode(theNode);
+}
+
+void AgaveFileTreeModel::refreshFolder(const QModelIndex &folderIndex)
+{
+    FileTreeNode * folderNode = folderIndex.isValid() ? nodeFromIndex(folderIndex) : rootNode;
+    if ((folderNode == NULL) || !isFolder(folderNode->fileData) || folderNode->fetching) return;
+
+    requestListing(folderNode);
+}
+
+QModelIndex AgaveFileTreeModel::index(int row, int column, const QModelIndex &parent) const
+{
+    FileTreeNode * parentNode = parent.isValid() ? nodeFromIndex(parent) : rootNode;
+    if ((parentNode == NULL) || (row < 0) || (row >= parentNode->children.size()) ||
+            (column < 0) || (column >= COLUMN_COUNT))
+    {
+        return QModelIndex();
+    }
+    return createIndex(row, column, parentNode->children.at(row));
+}
+
+QModelIndex AgaveFileTreeModel::parent(const QModelIndex &child) const
+{
+    FileTreeNode * childNode = nodeFromIndex(child);
+    if ((childNode == NULL) || (childNode->parent == NULL) || (childNode->parent == rootNode))
+    {
+        return QModelIndex();
+    }
+    return indexOfNode(childNode->parent);
+}
+
+int AgaveFileTreeModel::rowCount(const QModelIndex &parent) const
+{
+    if (parent.column() > 0) return 0;
+    FileTreeNode * parentNode = parent.isValid() ? nodeFromIndex(parent) : rootNode;
+    if (parentNode == NULL) return 0;
+    return parentNode->children.size();
+}
+
+int AgaveFileTreeModel::columnCount(const QModelIndex &) const
+{
+    return COLUMN_COUNT;
+}
+
+bool AgaveFileTreeModel::hasChildren(const QModelIndex &parent) const
+{
+    FileTreeNode * parentNode = parent.isValid() ? nodeFromIndex(parent) : rootNode;
+    if ((parentNode == NULL) || !isFolder(parentNode->fileData)) return false;
+
+    //A folder not yet listed may have children, so views show it as expandable
+    if (!parentNode->loaded) return true;
+    return !parentNode->children.isEmpty();
+}
+
+QVariant AgaveFileTreeModel::data(const QModelIndex &index, int role) const
+{
+    FileTreeNode * theNode = nodeFromIndex(index);
+    if (theNode == NULL) return QVariant();
+    const FileMetaData &fileData = theNode->fileData;
+
+    if (role == FullPathRole) return fileData.getFullPath();
+    if (role == FileTypeRole) return (int) fileData.getFileType();
+    if (role == FileSizeRole) return fileData.getSize();
+    if (role != Qt::DisplayRole) return QVariant();
+
+    if (fileData.getFileType() == FileType::UNLOADED)
+    {
+        return (index.column() == NAME_COLUMN) ? fileData.getFileTypeString() : QVariant();
+    }
+
+    switch (index.column())
+    {
+    case NAME_COLUMN : return fileData.getFileName();
+    case SIZE_COLUMN : return isFolder(fileData) ? QVariant() : QVariant(fileData.getSize());
+    case TYPE_COLUMN : return fileData.getFileTypeString();
+    case MODIFIED_COLUMN : return fileData.getModifiedTime();
+    }
+    return QVariant();
+}
+
+QVariant AgaveFileTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if ((orientation != Qt::Horizontal) || (role != Qt::DisplayRole)) return QVariant();
+
+    switch (section)
+    {
+    case NAME_COLUMN : return QString("Name");
+    case SIZE_COLUMN : return QString("Size");
+    case TYPE_COLUMN : return QString("Type");
+    case MODIFIED_COLUMN : return QString("Modified");
+    }
+    return QVariant();
+}
+
+bool AgaveFileTreeModel::canFetchMore(const QModelIndex &parent) const
+{
+    FileTreeNode * parentNode = parent.isValid() ? nodeFromIndex(parent) : rootNode;
+    if ((parentNode == NULL) || !isFolder(parentNode->fileData)) return false;
+    return (!parentNode->loaded && !parentNode->fetching);
+}
+
+void AgaveFileTreeModel::fetchMore(const QModelIndex &parent)
+{
+    FileTreeNode * parentNode = parent.isValid() ? nodeFromIndex(parent) : rootNode;
+    if ((parentNode == NULL) || !isFolder(parentNode->fileData) || parentNode->loaded || parentNode->fetching) return;
+
+    //Shown until the listing arrives
+    FileMetaData placeholderData;
+    placeholderData.setType(FileType::UNLOADED);
+
+    beginInsertRows(parent, 0, 0);
+    FileTreeNode * placeholderNode = newNode(placeholderData, parentNode);
+    parentNode->children.prepend(placeholderNode);
+    parentNode->hasPlaceholder = true;
+    endInsertRows();
+
+    requestListing(parentNode);
+}
+
+void AgaveFileTreeModel::gotListing(RequestState replyState, FileListing folderListing)
+{
+    auto itr = inFlightListings.find(QObject::sender());
+    if (itr == inFlightListings.end()) return;
+    QString folderKey = *itr;
+    inFlightListings.erase(itr);
+
+    //The folder may have been removed while it was being listed
+    FileTreeNode * folderNode = pathToNode.value(folderKey, NULL);
+    if (folderNode == NULL) return;
+    folderNode->fetching = false;
+
+    if (replyState != RequestState::GOOD)
+    {
+        //Not fetched again on its own, see refreshFolder
+        removePlaceholder(folderNode);
+        folderNode->loaded = true;
+        emit folderLoadFailed(folderKey, replyState);
+        return;
+    }
+
+    applyListing(folderNode, folderListing);
+    emit folderLoaded(folderKey);
+}
+
+void AgaveFileTreeModel::remoteListingChanged(QString dirPath, FileListing newListing)
+{
+    FileTreeNode * folderNode = pathToNode.value(AgaveListingCache::getCacheKey(dirPath), NULL);
+    if ((folderNode == NULL) || !folderNode->loaded) return;
+
+    applyListing(folderNode, newListing);
+}
+
+void AgaveFileTreeModel::remoteListingInvalidated(QString dirPath)
+{
+    FileTreeNode * folderNode = pathToNode.value(AgaveListingCache::getCacheKey(dirPath), NULL);
+    if ((folderNode == NULL) || !folderNode->loaded || folderNode->fetching) return;
+
+    requestListing(folderNode);
+}
+
+AgaveFileTreeModel::FileTreeNode * AgaveFileTreeModel::newNode(const FileMetaData &fileData, FileTreeNode * parent)
+{
+    FileTreeNode * ret = new FileTreeNode;
+    ret->fileData = fileData;
+    ret->parent = parent;
+    ret->loaded = false;
+    ret->fetching = false;
+    ret->hasPlaceholder = false;
+    if (fileData.getFileType() != FileType::UNLOADED)
+    {
+        pathToNode.insert(getNodePath(ret), ret);
+    }
+    return ret;
+}
+
+void AgaveFileTreeModel::deleteNode(FileTreeNode * theNode)
+{
+    for (FileTreeNode * aChild : theNode->children)
+    {
+        deleteNode(aChild);
+    }
+    if (theNode->fileData.getFileType() != FileType::UNLOADED)
+    {
+        pathToNode.remove(getNodePath(theNode));
+    }
+    delete theNode;
+}
+
+AgaveFileTreeModel::FileTreeNode * AgaveFileTreeModel::nodeFromIndex(const QModelIndex &index) const
+{
+    if (!index.isValid()) return NULL;
+    return static_cast<FileTreeNode *>(index.internalPointer());
+}
+
+QModelIndex AgaveFileTreeModel::indexOfNode(FileTreeNode * theNode, int column) const
+{
+    if ((theNode == NULL) || (theNode->parent == NULL)) return QModelIndex();
+    return createIndex(theNode->parent->children.indexOf(theNode), column, theNode);
+}
+
+QString AgaveFileTreeModel::getNodePath(FileTreeNode * theNode) const
+{
+    return AgaveListingCache::getCacheKey(theNode->fileData.getFullPath());
+}
+
+void AgaveFileTreeModel::requestListing(FileTreeNode * folderNode)
+{
+    QString folderKey = getNodePath(folderNode);
+    RemoteDataReply * listReply = myManager->remoteLS(folderKey);
+    if (listReply == NULL)
+    {
+        removePlaceholder(folderNode);
+        folderNode->loaded = true;
+        emit folderLoadFailed(folderKey, RequestState::NO_CONNECT);
+        return;
+    }
+    folderNode->fetching = true;
+    inFlightListings.insert(listReply, folderKey);
+    QObject::connect(listReply, SIGNAL(haveListingResult(RequestState,FileListing)),
+                     this, SLOT(gotListing(RequestState,FileListing)));
+}
+
+void AgaveFileTreeModel::applyListing(FileTreeNode * folderNode, const FileListing &folderListing)
+{
+    removePlaceholder(folderNode);
+    folderNode->loaded = true;
+
+    QString folderKey = getNodePath(folderNode);
+    QList<FileMetaData> newEntries;
+    newEntries.reserve(folderListing.size());
+    for (auto itr = folderListing.constBegin(); itr != folderListing.constEnd(); ++itr)
+    {
+        FileMetaData anEntry = (*itr).toFileMetaData();
+        //Agave lists the folder itself as "."
+        if (AgaveListingCache::getCacheKey(anEntry.getFullPath()) == folderKey) continue;
+        newEntries.append(anEntry);
+    }
+    std::sort(newEntries.begin(), newEntries.end(), [](const FileMetaData &entryA, const FileMetaData &entryB)
+    {
+        return compareEntries(entryA, entryB) < 0;
+    });
+
+    //Both lists are in row order, so one pass finds the runs of rows removed and inserted
+    QModelIndex folderIndex = indexOfNode(folderNode);
+    QList<FileTreeNode *> &children = folderNode->children;
+    int row = 0;
+    int newPos = 0;
+    while ((row < children.size()) || (newPos < newEntries.size()))
+    {
+        int compareVal;
+        if (row >= children.size()) compareVal = 1;
+        else if (newPos >= newEntries.size()) compareVal = -1;
+        else compareVal = compareEntries(children.at(row)->fileData, newEntries.at(newPos));
+
+        if (compareVal < 0)
+        {
+            int lastRow = row;
+            while ((lastRow + 1 < children.size()) && ((newPos >= newEntries.size()) ||
+                    (compareEntries(children.at(lastRow + 1)->fileData, newEntries.at(newPos)) < 0)))
+            {
+                lastRow++;
+            }
+            beginRemoveRows(folderIndex, row, lastRow);
+            for (int i = lastRow; i >= row; i--)
+            {
+                deleteNode(children.takeAt(i));
+            }
+            endRemoveRows();
+        }
+        else if (compareVal > 0)
+        {
+            int lastPos = newPos;
+            while ((lastPos + 1 < newEntries.size()) && ((row >= children.size()) ||
+                    (compareEntries(children.at(row)->fileData, newEntries.at(lastPos + 1)) > 0)))
+            {
+                lastPos++;
+            }
+            beginInsertRows(folderIndex, row, row + lastPos - newPos);
+            for (int i = newPos; i <= lastPos; i++)
+            {
+                children.insert(row + i - newPos, newNode(newEntries.at(i), folderNode));
+            }
+            endInsertRows();
+            row += lastPos - newPos + 1;
+            newPos = lastPos + 1;
+        }
+        else
+        {
+            FileTreeNode * sameNode = children.at(row);
+            if (entryChanged(sameNode->fileData, newEntries.at(newPos)))
+            {
+                sameNode->fileData = newEntries.at(newPos);
+                emit dataChanged(createIndex(row, 0, sameNode), createIndex(row, COLUMN_COUNT - 1, sameNode));
+            }
+            row++;
+            newPos++;
+        }
+    }
+}
+
+void AgaveFileTreeModel::removePlaceholder(FileTreeNode * folderNode)
+{
+    if (!folderNode->hasPlaceholder) return;
+
+    beginRemoveRows(indexOfNode(folderNode), 0, 0);
+    deleteNode(folderNode->children.takeFirst());
+    folderNode->hasPlaceholder = false;
+    endRemoveRows();
+}
+
+bool AgaveFileTreeModel::isFolder(const FileMetaData &fileData)
+{
+    return ((fileData.getFileType() == FileType::DIR) || (fileData.getFileType() == FileType::EMPTY_FOLDER));
+}
+
+int AgaveFileTreeModel::compareEntries(const FileMetaData &entryA, const FileMetaData &entryB)
+{
+    //Folders first, a name changing between file and folder is a different row
+    bool folderA = isFolder(entryA);
+    bool folderB = isFolder(entryB);
+    if (folderA != folderB) return folderA ? -1 : 1;
+
+    int compareVal = QString::compare(entryA.getFileName(), entryB.getFileName(), Qt::CaseInsensitive);
+    if (compareVal != 0) return compareVal;
+    return QString::compare(entryA.getFileName(), entryB.getFileName(), Qt::CaseSensitive);
+}
+
+bool AgaveFileTreeModel::entryChanged(const FileMetaData &oldEntry, const FileMetaData &newEntry)
+{
+    return ((oldEntry.getFileType() != newEntry.getFileType()) || (oldEntry.getSize() != newEntry.getSize()) ||
+            (oldEntry.getModifiedTime() != newEntry.getModifiedTime()));
+}
@@ -0,0 +1,132 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEFILETREEMODEL_H
+#define AGAVEFILETREEMODEL_H
+
+#include "../remotedatainterface.h"
+#include "../filemetadata.h"
+#include "../filelisting.h"
+
+#include <QAbstractItemModel>
+#include <QModelIndex>
+#include <QVariant>
+#include <QString>
+#include <QHash>
+#include <QList>
+
+class AgaveHandler;
+
+//Item model of a remote folder tree, for tree and list views
+//A folder's contents are listed only when a view asks for them (canFetchMore/fetchMore),
+//showing one Fetching (FileType::UNLOADED) row until the listing arrives.
+//Listings that arrive later, including updates after file operations done through the handler,
+//are applied as row inserts, removes and data changes, never as a model reset.
+//Rows are folders first, then files, each sorted by name.
+class AgaveFileTreeModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum FileTreeColumn {NAME_COLUMN = 0, SIZE_COLUMN, TYPE_COLUMN, MODIFIED_COLUMN, COLUMN_COUNT};
+    enum FileTreeRole {FullPathRole = Qt::UserRole, FileTypeRole, FileSizeRole};
+
+    explicit AgaveFileTreeModel(AgaveHandler * theManager, QObject * parent = NULL);
+    ~AgaveFileTreeModel();
+
+    //The only change made with a model reset
+    void setRootPath(QString rootPath);
+    QString getRootPath();
+
+    FileMetaData getFileData(const QModelIndex &index) const;
+    //Invalid if the path is not loaded
+    QModelIndex getIndexOfPath(QString fullPath);
+    //Lists a loaded folder again, keeping its rows until the new listing is applied
+    void refreshFolder(const QModelIndex &folderIndex);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const;
+    QModelIndex parent(const QModelIndex &child) const;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const;
+
+    bool canFetchMore(const QModelIndex &parent) const;
+    void fetchMore(const QModelIndex &parent);
+
+signals:
+    void folderLoaded(QString folderPath);
+    void folderLoadFailed(QString folderPath, RequestState replyState);
+
+private slots:
+    void gotListing(RequestState replyState, FileListing folderListing);
+    void remoteListingChanged(QString dirPath, FileListing newListing);
+    void remoteListingInvalidated(QString dirPath);
+
+private:
+    struct FileTreeNode
+    {
+        FileMetaData fileData;
+        FileTreeNode * parent;
+        QList<FileTreeNode *> children;
+        bool loaded;
+        bool fetching;
+        bool hasPlaceholder;
+    };
+
+    FileTreeNode * newNode(const FileMetaData &fileData, FileTreeNode * parent);
+    void deleteNode(FileTreeNode * theNode);
+    FileTreeNode * nodeFromIndex(const QModelIndex &index) const;
+    QModelIndex indexOfNode(FileTreeNode * theNode, int column = 0) const;
+    QString getNodePath(FileTreeNode * theNode) const;
+
+    void requestListing(FileTreeNode * folderNode);
+    void applyListing(FileTreeNode * folderNode, const FileListing &folderListing);
+    void removePlaceholder(FileTreeNode * folderNode);
+
+    static bool isFolder(const FileMetaData &fileData);
+    static int compareEntries(const FileMetaData &entryA, const FileMetaData &entryB);
+    static bool entryChanged(const FileMetaData &oldEntry, const FileMetaData &newEntry);
+
+    AgaveHandler * myManager = NULL;
+    QString rootKey;
+    FileTreeNode * rootNode = NULL;
+
+    //Loaded folders and files, by canonical path, the placeholders are not included
+    QHash<QString, FileTreeNode *> pathToNode;
+    QHash<QObject *, QString> inFlightListings;
+};
+
+#endif // AGAVEFILETREEMODEL_H
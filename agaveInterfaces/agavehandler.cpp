@@ -36,6 +36,18 @@
 #include "agavehandler.h"
 #include "agavetaskguide.h"
 #include "agavetaskreply.h"
+#include "agavejobquery.h"
+#include "agavelogging.h"
+#include "agavejsonkeypath.h"
+#include "agavejobwatcher.h"
+#include "agavenotificationlistener.h"
+#include "agavejobbatchreply.h"
+#include "agavesweepreply.h"
+#include "agaveparametersweep.h"
+#include "agavestagingpipeline.h"
+#include "agavejobharvester.h"
+#include "agavetreewalker.h"
+#include "agavefilefollower.h"
 
 #include "../filemetadata.h"
 #include "../remotejobdata.h"
@@ -50,6 +62,7 @@ AgaveHandler::AgaveHandler(QObject * parent) :
 
     setupTaskGuideList();
     QObject::connect(&networkHandle, SIGNAL(finished(QNetworkReply*)), this, SLOT(finishedOneTask(QNetworkReply*)));
+    QObject::connect(&prefetchTimer, SIGNAL(timeout()), this, SLOT(issuePrefetch()));
 }
 
 void AgaveHandler::finishedOneTask(QNetworkReply *)
@@ -115,72 +128,8 @@ RemoteDataReply * AgaveHandler::setCurrentRemoteWorkingDirectory(QString cd)
 
 QString AgaveHandler::getPathReletiveToCWD(QString inputPath)
 {
-    //TODO: check validity of input path
-    QString cleanedInput = FileMetaData::cleanPathSlashes(inputPath);
-
-    QStringList retList;
-
-    if (inputPath.at(0) == '/')
-    {
-        QStringList oldList = cleanedInput.split('/');
-
-        for (auto itr = oldList.cbegin(); itr != oldList.cend(); itr++)
-        {
-            if ((*itr) == ".") {}
-            else if ((*itr) == "..")
-            {
-                retList.removeLast();
-            }
-            else if (!(*itr).isEmpty())
-            {
-                retList.append(*itr);
-            }
-        }
-    }
-    else
-    {
-        QStringList oldList = pwd.split('/');
-        QStringList newList = cleanedInput.split('/');
-
-        for (auto itr = oldList.cbegin(); itr != oldList.cend(); itr++)
-        {
-            if ((*itr) == ".") {}
-            else if ((*itr) == "..")
-            {
-                retList.removeLast();
-            }
-            else if (!(*itr).isEmpty())
-            {
-                retList.append(*itr);
-            }
-        }
-
-        for (auto itr = newList.cbegin(); itr != newList.cend(); itr++)
-        {
-            if ((*itr) == ".") {}
-            else if ((*itr) == "..")
-            {
-                retList.removeLast();
-            }
-            else if (!(*itr).isEmpty())
-            {
-                retList.append(*itr);
-            }
-        }
-    }
-
-    QString ret;
-
-    for (auto itr = retList.cbegin(); itr != retList.cend(); itr++)
-    {
-        if (!(*itr).isEmpty())
-        {
-            ret.append('/');
-            ret.append(*itr);
-        }
-    }
-
-    return ret;
+    //Note: An empty input gives the current directory, the root is given as an empty string
+    return FileMetaData::canonicalizePath(pwd, inputPath);
 }
 
 RemoteDataReply * AgaveHandler::performAuth(QString uname, QString passwd)
@@ -221,7 +170,58 @@ RemoteDataReply * AgaveHandler::remoteLS(QString dirPath)
         tmp.append(authUname);
     }
 
+    FileListing cachedListing;
+    if (listingCache.lookupListing(tmp, &cachedListing))
+    {
+        AgaveTaskReply * passThru = new AgaveTaskReply(retriveTaskGuide("cachedDirListing"),NULL,this,(QObject *)this);
+        passThru->getTaskParamList()->insert("dirPath", tmp);
+        passThru->setPassThruListing(cachedListing);
+        passThru->delayedPassThruReply(RequestState::GOOD);
+        schedulePrefetch(tmp, cachedListing);
+        return (RemoteDataReply *) passThru;
+    }
+
+    //The last known listing is shown right away, and checked with a fresh listing
+    FileListing storedListing;
+    if (metadataStore.loadListing(tmp, &storedListing))
+    {
+        AgaveTaskReply * passThru = new AgaveTaskReply(retriveTaskGuide("cachedDirListing"),NULL,this,(QObject *)this);
+        passThru->getTaskParamList()->insert("dirPath", tmp);
+        passThru->setPassThruListing(storedListing);
+        passThru->delayedPassThruReply(RequestState::GOOD);
+
+        QString storeKey = AgaveListingCache::getCacheKey(tmp);
+        if (!revalidatingListings.contains(storeKey))
+        {
+            AgaveTaskReply * freshReply = performAgaveQuery("dirListing", tmp);
+            if (freshReply != NULL)
+            {
+                freshReply->getTaskParamList()->insert("dirPath", tmp);
+                revalidatingListings.insert(storeKey, storedListing);
+                QObject::connect(freshReply, SIGNAL(haveListingResult(RequestState,FileListing)),
+                                 this, SLOT(revalidatedListing(RequestState,FileListing)));
+            }
+        }
+        return (RemoteDataReply *) passThru;
+    }
+
+    return remoteLSFresh(tmp);
+}
+
+RemoteDataReply * AgaveHandler::remoteLSFresh(QString dirPath)
+{
+    QString tmp = getPathReletiveToCWD(dirPath);
+    if ((tmp.isEmpty()) || (tmp == "/") || (tmp == ""))
+    {
+        tmp = "/";
+        tmp.append(authUname);
+    }
+
     AgaveTaskReply * theReply = performAgaveQuery("dirListing", tmp);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("dirPath", tmp);
 
     return (RemoteDataReply *) theReply;
@@ -232,6 +232,10 @@ RemoteDataReply * AgaveHandler::deleteFile(QString toDelete)
     QString toCheck = getPathReletiveToCWD(toDelete);
 
     AgaveTaskReply * theReply = performAgaveQuery("fileDelete", toCheck);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("toDelete", toCheck);
 
     return (RemoteDataReply *) theReply;
@@ -243,6 +247,10 @@ RemoteDataReply * AgaveHandler::moveFile(QString from, QString to)
     QString toCheck = getPathReletiveToCWD(to);
     //TODO: check stuff is valid
     AgaveTaskReply * theReply = performAgaveQuery("fileMove", fromCheck, toCheck);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("from", fromCheck);
     theReply->getTaskParamList()->insert("to", toCheck);
 
@@ -255,6 +263,10 @@ RemoteDataReply * AgaveHandler::copyFile(QString from, QString to)
     QString toCheck = getPathReletiveToCWD(to);
     //TODO: check stuff is valid
     AgaveTaskReply * theReply = performAgaveQuery("fileCopy", fromCheck, toCheck);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("from", fromCheck);
     theReply->getTaskParamList()->insert("to", toCheck);
 
@@ -266,6 +278,10 @@ RemoteDataReply * AgaveHandler::renameFile(QString fullName, QString newName)
     QString toCheck = getPathReletiveToCWD(fullName);
     //TODO: check that path and new name is valid
     AgaveTaskReply * theReply = performAgaveQuery("renameFile", toCheck, newName);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("fullName", toCheck);
     theReply->getTaskParamList()->insert("newName", newName);
 
@@ -277,6 +293,10 @@ RemoteDataReply * AgaveHandler::mkRemoteDir(QString location, QString newName)
     QString toCheck = getPathReletiveToCWD(location);
     //TODO: check that path and new name is valid
     AgaveTaskReply * theReply = performAgaveQuery("newFolder", toCheck, newName);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("location", toCheck);
     theReply->getTaskParamList()->insert("newName", newName);
 
@@ -288,6 +308,10 @@ RemoteDataReply * AgaveHandler::uploadFile(QString location, QString localFileNa
     QString toCheck = getPathReletiveToCWD(location);
     //TODO: check that path and local file exists
     AgaveTaskReply * theReply = performAgaveQuery("fileUpload", toCheck, localFileName);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("location", toCheck);
     theReply->getTaskParamList()->insert("localFileName", localFileName);
 
@@ -299,6 +323,10 @@ RemoteDataReply * AgaveHandler::uploadBuffer(QString location, QByteArray fileDa
     QString toCheck = getPathReletiveToCWD(location);
     //TODO: check that path and local file exists
     AgaveTaskReply * theReply = performAgaveQuery("filePipeUpload", toCheck, fileData);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("location", toCheck);
 
     return (RemoteDataReply *) theReply;
@@ -309,6 +337,10 @@ RemoteDataReply * AgaveHandler::downloadFile(QString localDest, QString remoteNa
     //TODO: check path and local path
     QString toCheck = getPathReletiveToCWD(remoteName);
     AgaveTaskReply * theReply = performAgaveQuery("fileDownload", toCheck, localDest);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("remoteName", toCheck);
     theReply->getTaskParamList()->insert("localDest", localDest);
 
@@ -320,6 +352,10 @@ RemoteDataReply * AgaveHandler::downloadBuffer(QString remoteName)
     //TODO: check path
     QString toCheck = getPathReletiveToCWD(remoteName);
     AgaveTaskReply * theReply = performAgaveQuery("filePipeDownload", toCheck);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("remoteName", toCheck);
 
     return (RemoteDataReply *) theReply;
@@ -331,33 +367,214 @@ AgaveTaskReply *AgaveHandler::getAgaveAppList()
 }
 
 RemoteDataReply * AgaveHandler::runRemoteJob(QString jobName, QMultiMap<QString, QString> jobParameters, QString remoteWorkingDir)
+{
+    QJsonObject jobTemplate = getAgaveJobTemplate(jobName);
+    if (jobTemplate.isEmpty())
+    {
+        return NULL;
+    }
+    return runRemoteJobFromTemplate(jobName, jobTemplate, jobParameters, remoteWorkingDir);
+}
+
+AgaveJobBatchReply * AgaveHandler::runRemoteJobs(QString jobName, QList<QMultiMap<QString, QString> > jobList, QString remoteWorkingDir, int maxInFlight)
+{
+    QJsonObject jobTemplate = getAgaveJobTemplate(jobName);
+    if (jobTemplate.isEmpty())
+    {
+        return NULL;
+    }
+
+    AgaveJobBatchReply * batchReply = new AgaveJobBatchReply(this, jobName, jobTemplate, remoteWorkingDir, maxInFlight, (QObject *)this);
+    batchReply->setJobList(jobList);
+    batchReply->startBatch();
+    return batchReply;
+}
+
+AgaveSweepReply * AgaveHandler::runParameterSweep(QString jobName, AgaveParameterSweep theSweep, QString remoteWorkingDir,
+                                                  QString checkpointFile, int maxInFlight, int submitInterval)
+{
+    QJsonObject jobTemplate = getAgaveJobTemplate(jobName);
+    if (jobTemplate.isEmpty())
+    {
+        return NULL;
+    }
+
+    //Checked once here, rather than failing on every point
+    AgaveTaskGuide * appGuide = retriveTaskGuide(jobName);
+    QStringList sweepParams = theSweep.getParameterNames();
+    for (auto itr = sweepParams.cbegin(); itr != sweepParams.cend(); itr++)
+    {
+        if (!appGuide->isAgaveParam(*itr) && !appGuide->isAgaveInput(*itr))
+        {
+            qCWarning(agaveRequests, "Sweep parameter %s is not registered for %s", qPrintable(*itr), qPrintable(jobName));
+            return NULL;
+        }
+    }
+
+    qint64 pointCount = theSweep.getPointCount();
+    if ((pointCount <= 0) || (pointCount > std::numeric_limits<int>::max()))
+    {
+        return NULL;
+    }
+
+    AgaveSweepReply * sweepReply = new AgaveSweepReply(this, jobName, jobTemplate, remoteWorkingDir, maxInFlight, theSweep, (QObject *)this);
+    if (!checkpointFile.isEmpty() && !sweepReply->setCheckpointFile(checkpointFile))
+    {
+        qCWarning(agaveRequests, "Unable to open sweep checkpoint file: %s", qPrintable(checkpointFile));
+        sweepReply->deleteLater();
+        return NULL;
+    }
+    sweepReply->setSubmitInterval(submitInterval);
+    sweepReply->startBatch();
+    return sweepReply;
+}
+
+AgaveStagingPipeline * AgaveHandler::createStagingPipeline(int maxUploads)
+{
+    return new AgaveStagingPipeline(this, maxUploads);
+}
+
+QString AgaveHandler::getAgaveFileURL(QString remotePath)
+{
+    QString fullPath = getPathReletiveToCWD(remotePath);
+    if (!fullPath.startsWith('/'))
+    {
+        fullPath.prepend('/');
+    }
+    return QString("agave://%1%2").arg(storageNode, fullPath);
+}
+
+RemoteDataReply * AgaveHandler::readRemoteRange(QString remoteName, qint64 offset, qint64 length)
+{
+    if ((offset < 0) || (length == 0))
+    {
+        return NULL;
+    }
+
+    QString rangeSpec = QString("bytes=%1-").arg(offset);
+    if (length > 0)
+    {
+        rangeSpec.append(QString::number(offset + length - 1));
+    }
+
+    QString toCheck = getPathReletiveToCWD(remoteName);
+    AgaveTaskReply * theReply = performAgaveQuery("fileRangeDownload", toCheck, rangeSpec);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
+    theReply->getTaskParamList()->insert("remoteName", toCheck);
+    theReply->getTaskParamList()->insert("offset", QString::number(offset));
+
+    return (RemoteDataReply *) theReply;
+}
+
+RemoteDataReply * AgaveHandler::readRemoteTail(QString remoteName, qint64 length)
+{
+    if (length <= 0)
+    {
+        return NULL;
+    }
+
+    //A suffix range, which the server resolves against the file size
+    QString rangeSpec = QString("bytes=-%1").arg(length);
+
+    QString toCheck = getPathReletiveToCWD(remoteName);
+    AgaveTaskReply * theReply = performAgaveQuery("fileRangeDownload", toCheck, rangeSpec);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
+    theReply->getTaskParamList()->insert("remoteName", toCheck);
+    theReply->getTaskParamList()->insert("tail", QString::number(length));
+
+    return (RemoteDataReply *) theReply;
+}
+
+AgaveFileFollower * AgaveHandler::followRemoteFile(QString remoteName, qint64 startOffset)
+{
+    AgaveFileFollower * newFollower = new AgaveFileFollower(this, getPathReletiveToCWD(remoteName));
+    newFollower->startFollowing(startOffset);
+    return newFollower;
+}
+
+QString AgaveHandler::getStorageSystem()
+{
+    return storageNode;
+}
+
+AgaveJobHarvester * AgaveHandler::getJobHarvester()
+{
+    if (jobHarvester == NULL)
+    {
+        jobHarvester = new AgaveJobHarvester(this);
+    }
+    return jobHarvester;
+}
+
+AgaveTreeWalker * AgaveHandler::walkRemoteTree(QString rootPath, int maxInFlight)
+{
+    return new AgaveTreeWalker(this, getPathReletiveToCWD(rootPath), maxInFlight);
+}
+
+AgaveTreeWalker * AgaveHandler::findRemoteFiles(QString rootPath, QString wildcardPattern, int maxInFlight)
+{
+    AgaveTreeWalker * newWalker = new AgaveTreeWalker(this, getPathReletiveToCWD(rootPath), maxInFlight);
+    newWalker->setNamePattern(wildcardPattern);
+    return newWalker;
+}
+
+AgaveTreeWalker * AgaveHandler::deleteRemoteTree(QString rootPath, int maxInFlight)
+{
+    AgaveTreeWalker * newWalker = new AgaveTreeWalker(this, getPathReletiveToCWD(rootPath), maxInFlight);
+    newWalker->setDeleteAfterWalk(true);
+    return newWalker;
+}
+
+QJsonObject AgaveHandler::getAgaveJobTemplate(QString jobName)
 {
     //This function is only for Agave Jobs
     AgaveTaskGuide * guideToCheck = retriveTaskGuide(jobName);
     if (guideToCheck == NULL)
     {
-        return NULL;
+        return QJsonObject();
     }
     if (guideToCheck->getRequestType() != AgaveRequestType::AGAVE_APP)
     {
-        return NULL;
+        return QJsonObject();
     }
     QString fullAgaveName = guideToCheck->getAgaveFullName();
     if (fullAgaveName.isEmpty())
     {
         emit sendFatalErrorMessage("Agave App does not have a full name");
-        return NULL;
+        return QJsonObject();
     }
 
-    QJsonDocument rawJSONinput;
     QJsonObject rootObject;
     rootObject.insert("appId",QJsonValue(fullAgaveName));
     rootObject.insert("name",QJsonValue(fullAgaveName.append("-run")));
-    QJsonObject inputList;
-    QJsonObject paramList;
 
-    QStringList expectedInputs = guideToCheck->getAgaveInputList();
-    QStringList expectedParams = guideToCheck->getAgaveParamList();
+    if ((notificationListener != NULL) && notificationListener->isListening())
+    {
+        QJsonObject notifyObject;
+        notifyObject.insert("url", notificationListener->getCallbackURL());
+        notifyObject.insert("event", "*");
+        notifyObject.insert("persistent", true);
+        QJsonArray notifyList;
+        notifyList.append(notifyObject);
+        rootObject.insert("notifications", notifyList);
+    }
+
+    return rootObject;
+}
+
+RemoteDataReply * AgaveHandler::runRemoteJobFromTemplate(QString jobName, const QJsonObject &jobTemplate, QMultiMap<QString, QString> jobParameters, QString remoteWorkingDir)
+{
+    AgaveTaskGuide * guideToCheck = retriveTaskGuide(jobName);
+    if ((guideToCheck == NULL) || (guideToCheck->getRequestType() != AgaveRequestType::AGAVE_APP))
+    {
+        return NULL;
+    }
 
     if ((!guideToCheck->getAgavePWDparam().isEmpty()) && (!remoteWorkingDir.isEmpty()))
     {
@@ -366,17 +583,20 @@ RemoteDataReply * AgaveHandler::runRemoteJob(QString jobName, QMultiMap<QString,
         jobParameters.insert(guideToCheck->getAgavePWDparam(),realPath);
     }
 
-    QList<QString> keyList = jobParameters.keys();
-    for (auto itr = keyList.cbegin(); itr != keyList.cend(); itr++)
+    QJsonObject inputList;
+    QJsonObject paramList;
+
+    //Values of one key are next to each other in the map, in the same order values(key) gives
+    for (auto itr = jobParameters.cbegin(); itr != jobParameters.cend();)
     {
-        QList<QString> valueList = jobParameters.values(*itr);
+        const QString &theKey = itr.key();
         QJsonObject * objectToAddTo;
 
-        if (expectedParams.contains(*itr))
+        if (guideToCheck->isAgaveParam(theKey))
         {
             objectToAddTo = &paramList;
         }
-        else if (expectedInputs.contains(*itr))
+        else if (guideToCheck->isAgaveInput(theKey))
         {
             objectToAddTo = &inputList;
         }
@@ -385,29 +605,32 @@ RemoteDataReply * AgaveHandler::runRemoteJob(QString jobName, QMultiMap<QString,
             return NULL;
         }
 
-        if (valueList.size() > 1)
+        QJsonValue firstValue(itr.value());
+        itr++;
+        if ((itr == jobParameters.cend()) || (itr.key() != theKey))
         {
-            QJsonArray inList;
-            for (int i = 0; i < valueList.size(); i++)
-            {
-                inList.append(QJsonValue(valueList.at(i)));
-            }
-            objectToAddTo->insert(*itr,QJsonValue(inList));
+            objectToAddTo->insert(theKey, firstValue);
+            continue;
         }
-        else
+
+        QJsonArray inList;
+        inList.append(firstValue);
+        for (; (itr != jobParameters.cend()) && (itr.key() == theKey); itr++)
         {
-            objectToAddTo->insert(*itr,QJsonValue(valueList.at(0)));
+            inList.append(QJsonValue(itr.value()));
         }
+        objectToAddTo->insert(theKey, QJsonValue(inList));
     }
-    QJsonValue inputListValue(inputList);
-    QJsonValue paramListValue(paramList);
-    rootObject.insert("inputs",inputListValue);
-    rootObject.insert("parameters",paramListValue);
-    rawJSONinput.setObject(rootObject);
 
-    qDebug("%s",qPrintable(rawJSONinput.toJson()));
+    QJsonObject rootObject = jobTemplate;
+    rootObject.insert("inputs",QJsonValue(inputList));
+    rootObject.insert("parameters",QJsonValue(paramList));
 
-    AgaveTaskReply * theReply = performAgaveQuery("agaveAppStart", QString(rawJSONinput.toJson()));
+    AgaveTaskReply * theReply = performAgaveQuery("agaveAppStart", QString(QJsonDocument(rootObject).toJson(QJsonDocument::Compact)));
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("jobName", jobName);
     theReply->getTaskParamList()->insert("remoteWorkingDir", remoteWorkingDir);
     *(theReply->getTaskParamList()) += jobParameters;
@@ -417,12 +640,54 @@ RemoteDataReply * AgaveHandler::runRemoteJob(QString jobName, QMultiMap<QString,
 
 RemoteDataReply * AgaveHandler::getListOfJobs()
 {
-    return (RemoteDataReply *) performAgaveQuery("getJobList", NULL, NULL, NULL);
+    AgaveJobQuery emptyQuery;
+    return getListOfJobs(emptyQuery);
+}
+
+RemoteDataReply * AgaveHandler::getListOfJobs(AgaveJobQuery jobQuery)
+{
+    QString queryString = jobQuery.getURLQueryString();
+
+    //Only the unrestricted list is kept in the metadata store
+    QList<RemoteJobData> storedJobList;
+    if (queryString.isEmpty() && metadataStore.loadJobList(&storedJobList))
+    {
+        AgaveTaskReply * passThru = new AgaveTaskReply(retriveTaskGuide("cachedJobList"),NULL,this,(QObject *)this);
+        passThru->setPassThruJobList(storedJobList);
+        passThru->delayedPassThruReply(RequestState::GOOD);
+
+        if (!jobListRevalidating)
+        {
+            AgaveTaskReply * freshReply = performAgaveQuery("getJobList", queryString);
+            if (freshReply != NULL)
+            {
+                freshReply->getTaskParamList()->insert("jobQuery", queryString);
+                jobListRevalidating = true;
+                revalidatingJobList = storedJobList;
+                QObject::connect(freshReply, SIGNAL(haveJobListResult(RequestState,QList<RemoteJobData>)),
+                                 this, SLOT(revalidatedJobList(RequestState,QList<RemoteJobData>)));
+            }
+        }
+        return (RemoteDataReply *) passThru;
+    }
+
+    AgaveTaskReply * theReply = performAgaveQuery("getJobList", queryString);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
+    theReply->getTaskParamList()->insert("jobQuery", queryString);
+
+    return (RemoteDataReply *) theReply;
 }
 
 RemoteDataReply * AgaveHandler::getJobDetails(QString IDstr)
 {
     AgaveTaskReply * theReply = performAgaveQuery("getJobDetails", IDstr);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("IDstr", IDstr);
 
     return (RemoteDataReply *) theReply;
@@ -431,6 +696,10 @@ RemoteDataReply * AgaveHandler::getJobDetails(QString IDstr)
 RemoteDataReply * AgaveHandler::stopJob(QString IDstr)
 {
     AgaveTaskReply * theReply = performAgaveQuery("stopJob", IDstr);
+    if (theReply == NULL)
+    {
+        return NULL;
+    }
     theReply->getTaskParamList()->insert("IDstr", IDstr);
 
     return (RemoteDataReply *) theReply;
@@ -457,13 +726,13 @@ RemoteDataReply * AgaveHandler::closeAllConnections()
     }
     if ((clientEncoded != "") && (token != ""))
     {
-        qDebug("Closing all connections sequence begins");
+        qCDebug(agaveAuth, "Closing all connections sequence begins");
         performAgaveQuery("authRevoke", token);
         //maybe TODO: Remove client entry?
     }
     else
     {
-        qDebug("Not logged in: quick shutdown");
+        qCDebug(agaveAuth, "Not logged in: quick shutdown");
         clearAllAuthTokens();
     }
     QObject::connect(this, SIGNAL(finishedAllTasks()), waitHandle, SLOT(rawTaskComplete()));
@@ -489,6 +758,309 @@ void AgaveHandler::clearAllAuthTokens()
     authPass = "";
     clientKey = "";
     clientSecret = "";
+
+    listingCache.clear();
+    conditionalCache.clear();
+    searchIndex.clear();
+
+    prefetchTimer.stop();
+    prefetchQueue.clear();
+
+    if (jobWatcher != NULL)
+    {
+        jobWatcher->unwatchAll();
+    }
+
+    metadataStore.closeStore();
+    revalidatingListings.clear();
+    revalidatingJobList.clear();
+    jobListRevalidating = false;
+}
+
+void AgaveHandler::setListingCacheTTL(int msecs)
+{
+    listingCache.setTimeToLive(msecs);
+}
+
+AgaveListingCache * AgaveHandler::getListingCache()
+{
+    return &listingCache;
+}
+
+void AgaveHandler::setSearchIndexEnabled(bool enable)
+{
+    searchIndex.setEnabled(enable);
+}
+
+AgaveFileSearchIndex * AgaveHandler::getSearchIndex()
+{
+    return &searchIndex;
+}
+
+void AgaveHandler::cacheListingResult(QString dirPath, FileListing newListing, bool fromPrefetch, bool fromBackground)
+{
+    listingCache.storeListing(dirPath, newListing);
+    searchIndex.indexListing(dirPath, newListing);
+    metadataStore.saveListing(dirPath, newListing);
+
+    if (fromPrefetch)
+    {
+        prefetchEntriesUsed += newListing.size();
+    }
+    else if (!fromBackground)
+    {
+        schedulePrefetch(dirPath, newListing);
+    }
+}
+
+AgaveJobWatcher * AgaveHandler::getJobWatcher()
+{
+    if (jobWatcher == NULL)
+    {
+        jobWatcher = new AgaveJobWatcher(this);
+    }
+    return jobWatcher;
+}
+
+bool AgaveHandler::enableJobNotifications(QString publicHost, quint16 port, int pushTimeoutMsecs)
+{
+    if (notificationListener == NULL)
+    {
+        notificationListener = new AgaveNotificationListener(this);
+        QObject::connect(notificationListener, SIGNAL(jobEventReceived(QString,QString)),
+                         getJobWatcher(), SLOT(applyPushedState(QString,QString)));
+    }
+    notificationTimeout = pushTimeoutMsecs;
+    return notificationListener->startListening(publicHost, port);
+}
+
+void AgaveHandler::disableJobNotifications()
+{
+    if (notificationListener != NULL)
+    {
+        notificationListener->stopListening();
+    }
+}
+
+AgaveNotificationListener * AgaveHandler::getNotificationListener()
+{
+    return notificationListener;
+}
+
+void AgaveHandler::jobSubmitted(QString jobID, QString jobState)
+{
+    if ((notificationListener == NULL) || !notificationListener->isListening()) return;
+
+    getJobWatcher()->watchPushedJob(jobID, jobState, notificationTimeout);
+}
+
+AgaveConditionalCache * AgaveHandler::getConditionalCache()
+{
+    return &conditionalCache;
+}
+
+void AgaveHandler::setListingPrefetch(int childLimit, int requestsPerSec, int entryBudget)
+{
+    prefetchChildLimit = childLimit;
+    prefetchEntryBudget = entryBudget;
+    if (requestsPerSec <= 0)
+    {
+        requestsPerSec = 1;
+    }
+    prefetchTimer.setInterval(1000 / requestsPerSec);
+
+    if (prefetchChildLimit <= 0)
+    {
+        prefetchTimer.stop();
+        prefetchQueue.clear();
+    }
+}
+
+void AgaveHandler::schedulePrefetch(QString dirPath, FileListing dirListing)
+{
+    if ((prefetchChildLimit <= 0) || !listingCache.isEnabled()) return;
+
+    //Only the most recently listed folder is of interest
+    prefetchQueue.clear();
+    prefetchEntriesUsed = 0;
+
+    QString dirKey = AgaveListingCache::getCacheKey(dirPath);
+    FileListing alreadyCached;
+    for (auto itr = dirListing.constBegin(); (itr != dirListing.constEnd()) && (prefetchQueue.size() < prefetchChildLimit); ++itr)
+    {
+        if ((*itr).getFileType() != FileType::DIR) continue;
+
+        QString childKey = AgaveListingCache::getCacheKey((*itr).getFullPath());
+        //Agave lists the folder itself as "."
+        if (childKey == dirKey) continue;
+        if (listingCache.peekListing(childKey, &alreadyCached)) continue;
+
+        prefetchQueue.append(childKey);
+    }
+
+    if (!prefetchQueue.isEmpty() && !prefetchTimer.isActive())
+    {
+        prefetchTimer.start();
+    }
+}
+
+void AgaveHandler::issuePrefetch()
+{
+    if (prefetchQueue.isEmpty() || !authGained || performingShutdown
+            || (prefetchEntriesUsed >= prefetchEntryBudget))
+    {
+        prefetchTimer.stop();
+        prefetchQueue.clear();
+        return;
+    }
+
+    //Foreground requests, or an earlier prefetch, are still pending: try again on the next tick
+    if (pendingRequestCount > 0) return;
+
+    QString childKey = prefetchQueue.takeFirst();
+    FileListing alreadyCached;
+    if (listingCache.peekListing(childKey, &alreadyCached)) return;
+
+    issuingPrefetch = true;
+    AgaveTaskReply * prefetchReply = performAgaveQuery("dirListing", childKey);
+    issuingPrefetch = false;
+    if (prefetchReply == NULL) return;
+
+    prefetchReply->getTaskParamList()->insert("dirPath", childKey);
+    prefetchReply->getTaskParamList()->insert("prefetch", "true");
+    qCDebug(agaveRequests, "Prefetching listing of %s", qPrintable(childKey));
+}
+
+void AgaveHandler::cacheJobListResult(QString jobQuery, QList<RemoteJobData> newJobList)
+{
+    if (jobQuery.isEmpty())
+    {
+        metadataStore.saveJobList(newJobList);
+    }
+}
+
+void AgaveHandler::enableMetadataStore(QString storeDir)
+{
+    metadataStoreDir = storeDir;
+    if (metadataStoreDir.isEmpty())
+    {
+        metadataStore.closeStore();
+        return;
+    }
+    if (authGained)
+    {
+        metadataStore.openStore(metadataStoreDir, authUname, storageNode);
+    }
+}
+
+AgaveMetadataStore * AgaveHandler::getMetadataStore()
+{
+    return &metadataStore;
+}
+
+void AgaveHandler::revalidatedListing(RequestState replyState, FileListing newListing)
+{
+    AgaveTaskReply * freshReply = qobject_cast<AgaveTaskReply *>(QObject::sender());
+    if (freshReply == NULL) return;
+
+    QString storeKey = AgaveListingCache::getCacheKey(freshReply->getTaskParamList()->value("dirPath"));
+    FileListing shownListing = revalidatingListings.take(storeKey);
+    if (replyState != RequestState::GOOD) return;
+
+    if (shownListing != newListing)
+    {
+        emit remoteListingChanged(storeKey, newListing);
+    }
+}
+
+void AgaveHandler::revalidatedJobList(RequestState replyState, QList<RemoteJobData> newJobList)
+{
+    jobListRevalidating = false;
+    QList<RemoteJobData> shownJobList = revalidatingJobList;
+    revalidatingJobList.clear();
+    if (replyState != RequestState::GOOD) return;
+
+    bool listChanged = (shownJobList.size() != newJobList.size());
+    for (int i = 0; (!listChanged) && (i < newJobList.size()); i++)
+    {
+        listChanged = ((shownJobList.at(i).getID() != newJobList.at(i).getID()) ||
+                (shownJobList.at(i).getState() != newJobList.at(i).getState()) ||
+                (shownJobList.at(i).getName() != newJobList.at(i).getName()));
+    }
+    if (listChanged)
+    {
+        emit remoteJobListChanged(newJobList);
+    }
+}
+
+void AgaveHandler::applyFileOperationResult(AgaveTaskReply * agaveReply, FileMetaData * newFileData)
+{
+    QString taskID = agaveReply->getTaskGuide()->getTaskID();
+    QMultiMap<QString, QString> * taskParams = agaveReply->getTaskParamList();
+
+    //Files which are no longer where they were:
+    QString removedPath;
+    if (taskID == "fileDelete")
+    {
+        removedPath = taskParams->value("toDelete");
+    }
+    else if ((taskID == "fileMove") || (taskID == "renameFile"))
+    {
+        removedPath = taskParams->value((taskID == "fileMove") ? "from" : "fullName");
+    }
+
+    //A move keeps what the index knows of the moved folder's contents
+    if (!removedPath.isEmpty() && (newFileData != NULL) && (taskID != "fileDelete"))
+    {
+        searchIndex.moveTree(removedPath, *newFileData);
+    }
+    else if (!removedPath.isEmpty())
+    {
+        searchIndex.removeTree(removedPath);
+    }
+    else if ((newFileData != NULL) && (taskID != "fileDelete"))
+    {
+        searchIndex.removeTree(newFileData->getFullPath());
+        searchIndex.insertFile(*newFileData);
+    }
+
+    if (!removedPath.isEmpty())
+    {
+        listingCache.invalidateTree(removedPath);
+        metadataStore.removeTree(removedPath);
+        QString parentKey = AgaveListingCache::getParentKey(removedPath);
+        FileListing patchedListing;
+        if (listingCache.removeFile(removedPath) && listingCache.peekListing(parentKey, &patchedListing))
+        {
+            metadataStore.saveListing(parentKey, patchedListing);
+            emit remoteListingChanged(parentKey, patchedListing);
+        }
+        else
+        {
+            metadataStore.removeListing(parentKey);
+            emit remoteListingInvalidated(parentKey);
+        }
+    }
+
+    //Files which are new or changed:
+    if ((newFileData != NULL) && (taskID != "fileDelete"))
+    {
+        //A copy or move may replace an existing folder
+        listingCache.invalidateTree(newFileData->getFullPath());
+        metadataStore.removeTree(newFileData->getFullPath());
+        QString parentKey = AgaveListingCache::getCacheKey(newFileData->getContainingPath());
+        FileListing patchedListing;
+        if (listingCache.insertFile(*newFileData) && listingCache.peekListing(parentKey, &patchedListing))
+        {
+            metadataStore.saveListing(parentKey, patchedListing);
+            emit remoteListingChanged(parentKey, patchedListing);
+        }
+        else
+        {
+            metadataStore.removeListing(parentKey);
+            emit remoteListingInvalidated(parentKey);
+        }
+    }
 }
 
 void AgaveHandler::setupTaskGuideList()
@@ -504,16 +1076,24 @@ void AgaveHandler::setupTaskGuideList()
     toInsert = new AgaveTaskGuide("waitAll", AgaveRequestType::AGAVE_NONE);
     insertAgaveTaskGuide(toInsert);
 
+    toInsert = new AgaveTaskGuide("cachedDirListing", AgaveRequestType::AGAVE_NONE);
+    insertAgaveTaskGuide(toInsert);
+
+    toInsert = new AgaveTaskGuide("cachedJobList", AgaveRequestType::AGAVE_NONE);
+    insertAgaveTaskGuide(toInsert);
+
     toInsert = new AgaveTaskGuide("authStep1", AgaveRequestType::AGAVE_GET);
     toInsert->setURLsuffix(QString("/clients/v2/%1").arg(clientName));
     toInsert->setHeaderType(AuthHeaderType::PASSWD);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("authStep1a", AgaveRequestType::AGAVE_DELETE);
     toInsert->setURLsuffix(QString("/clients/v2/%1").arg(clientName));
     toInsert->setHeaderType(AuthHeaderType::PASSWD);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("authStep2", AgaveRequestType::AGAVE_POST);
@@ -521,6 +1101,7 @@ void AgaveHandler::setupTaskGuideList()
     toInsert->setHeaderType(AuthHeaderType::PASSWD);
     toInsert->setPostParams(QString("clientName=%1&description=Client ID for SimCenter Wind GUI App").arg(clientName),0);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("authStep3", AgaveRequestType::AGAVE_POST);
@@ -529,6 +1110,7 @@ void AgaveHandler::setupTaskGuideList()
     toInsert->setPostParams("username=%1&password=%2&grant_type=password&scope=PRODUCTION",2);
     toInsert->setTokenFormat(true);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("authRefresh", AgaveRequestType::AGAVE_POST);
@@ -537,6 +1119,7 @@ void AgaveHandler::setupTaskGuideList()
     toInsert->setPostParams("grant_type=refresh_token&scope=PRODUCTION&refresh_token=%1",1);
     toInsert->setTokenFormat(true);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("authRevoke", AgaveRequestType::AGAVE_POST);
@@ -544,12 +1127,15 @@ void AgaveHandler::setupTaskGuideList()
     toInsert->setHeaderType(AuthHeaderType::CLIENT);
     toInsert->setPostParams("token=%1",1);
     toInsert->setAsInternal();
+    toInsert->setAsSensitive();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("dirListing", AgaveRequestType::AGAVE_GET);
     toInsert->setURLsuffix((QString("/files/v2/listings/system/%1/")).arg(storageNode));
     toInsert->setDynamicURLParams("%1",1);
+    toInsert->setResponseFilter({"name", "path", "type", "format", "nativeFormat", "length", "lastModified"});
     toInsert->setHeaderType(AuthHeaderType::TOKEN);
+    toInsert->setAsConditional();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("fileUpload", AgaveRequestType::AGAVE_UPLOAD);
@@ -576,6 +1162,14 @@ void AgaveHandler::setupTaskGuideList()
     toInsert->setHeaderType(AuthHeaderType::TOKEN);
     insertAgaveTaskGuide(toInsert);
 
+    //The post params of a range download are the Range header
+    toInsert = new AgaveTaskGuide("fileRangeDownload", AgaveRequestType::AGAVE_RANGE_DOWNLOAD);
+    toInsert->setURLsuffix((QString("/files/v2/media/system/%1/")).arg(storageNode));
+    toInsert->setDynamicURLParams("%1",1);
+    toInsert->setPostParams("%1",1);
+    toInsert->setHeaderType(AuthHeaderType::TOKEN);
+    insertAgaveTaskGuide(toInsert);
+
     toInsert = new AgaveTaskGuide("fileDelete", AgaveRequestType::AGAVE_DELETE);
     toInsert->setURLsuffix((QString("/files/v2/media/system/%1/")).arg(storageNode));
     toInsert->setDynamicURLParams("%1",1);
@@ -622,13 +1216,17 @@ void AgaveHandler::setupTaskGuideList()
 
     toInsert = new AgaveTaskGuide("getJobList", AgaveRequestType::AGAVE_GET);
     toInsert->setURLsuffix(QString("/jobs/v2"));
+    toInsert->setDynamicURLParams("%1",1);
+    toInsert->setResponseFilter({"id", "name", "appId", "created", "status"});
     toInsert->setHeaderType(AuthHeaderType::TOKEN);
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("getJobDetails", AgaveRequestType::AGAVE_GET);
     toInsert->setURLsuffix(QString("/jobs/v2/"));
     toInsert->setDynamicURLParams("%1",1);
+    toInsert->setResponseFilter({"id", "name", "appId", "created", "status", "inputs", "parameters", "archivePath", "archiveSystem"});
     toInsert->setHeaderType(AuthHeaderType::TOKEN);
+    toInsert->setAsConditional();
     insertAgaveTaskGuide(toInsert);
 
     toInsert = new AgaveTaskGuide("stopJob", AgaveRequestType::AGAVE_POST);
@@ -678,9 +1276,15 @@ void AgaveHandler::forwardReplyToParent(AgaveTaskReply * agaveReply, RequestStat
 
 void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply * rawReply)
 {
+    static const AgaveJSONKeyPath messagePath("message");
+    static const AgaveJSONKeyPath consumerKeyPath({"result", "consumerKey"});
+    static const AgaveJSONKeyPath consumerSecretPath({"result", "consumerSecret"});
+    static const AgaveJSONKeyPath accessTokenPath("access_token");
+    static const AgaveJSONKeyPath refreshTokenPath("refresh_token");
+
     if (agaveReply->getTaskGuide()->getTaskID() == "authRevoke")
     {
-        qDebug("Auth revoke procedure complete");
+        qCDebug(agaveAuth, "Auth revoke procedure complete");
         clearAllAuthTokens();
         return;
     }
@@ -694,7 +1298,7 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
     {
         if (agaveReply->getTaskGuide()->getTaskID() == "getJobList")
         {
-            qDebug("Job Listing failed");
+            qCWarning(agaveReplies, "Job Listing failed");
         }
         else
         {
@@ -703,7 +1307,10 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
         return;
     }
 
-    qDebug("%s",qPrintable(parseHandler.toJson()));
+    if (!agaveReply->getTaskGuide()->isSensitive())
+    {
+        AGAVE_LOG_PAYLOAD("Internal reply", replyText);
+    }
 
     RequestState prelimResult = AgaveTaskReply::standardSuccessFailCheck(agaveReply->getTaskGuide(), &parseHandler);
 
@@ -730,7 +1337,7 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
         }
         else
         {
-            QString messageData = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, "message").toString();
+            QString messageData = messagePath.retriveValue(&parseHandler).toString();
             if (messageData == "Application not found")
             {
                 if (performAgaveQuery("authStep2", agaveReply->parent()) == NULL)
@@ -771,8 +1378,8 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
     {
         if (prelimResult == RequestState::GOOD)
         {
-            clientKey = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, {"result", "consumerKey"}).toString();
-            clientSecret = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, {"result", "consumerSecret"}).toString();
+            clientKey = consumerKeyPath.retriveValue(&parseHandler).toString();
+            clientSecret = consumerSecretPath.retriveValue(&parseHandler).toString();
 
             if (clientKey.isEmpty() || clientSecret.isEmpty())
             {
@@ -803,8 +1410,8 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
     {
         if (prelimResult == RequestState::GOOD)
         {
-            token = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, "access_token").toString().toLatin1();
-            refreshToken = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, "refresh_token").toString().toLatin1();
+            token = accessTokenPath.retriveValue(&parseHandler).toString().toLatin1();
+            refreshToken = refreshTokenPath.retriveValue(&parseHandler).toString().toLatin1();
 
             if (token.isEmpty() || refreshToken.isEmpty())
             {
@@ -818,8 +1425,13 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
                 authGained = true;
                 attemptingAuth = false;
 
+                if (!metadataStoreDir.isEmpty())
+                {
+                    metadataStore.openStore(metadataStoreDir, authUname, storageNode);
+                }
+
                 forwardReplyToParent(agaveReply, RequestState::GOOD);
-                qDebug("Login success.");
+                qCDebug(agaveAuth, "Login success.");
             }
         }
         else
@@ -832,8 +1444,8 @@ void AgaveHandler::handleInternalTask(AgaveTaskReply * agaveReply, QNetworkReply
     {
         if (prelimResult == RequestState::GOOD)
         {
-            token = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, "access_token").toString().toLatin1();
-            refreshToken = AgaveTaskReply::retriveMainAgaveJSON(&parseHandler, "refresh_token").toString().toLatin1();
+            token = accessTokenPath.retriveValue(&parseHandler).toString().toLatin1();
+            refreshToken = refreshTokenPath.retriveValue(&parseHandler).toString().toLatin1();
 
             if (token.isEmpty() || refreshToken.isEmpty())
             {
@@ -881,7 +1493,7 @@ AgaveTaskReply * AgaveHandler::performAgaveQuery(QString queryName, QStringList
 
     if ((performingShutdown) && (queryName != "authRevoke"))
     {
-        qDebug("Rejecting request given during shutdown.");
+        qCDebug(agaveRequests, "Rejecting request given during shutdown.");
         return NULL;
     }
 
@@ -950,6 +1562,15 @@ QNetworkReply * AgaveHandler::internalQueryMethod(AgaveTaskGuide * taskGuide, QS
 
     QByteArray realURLsuffix = taskGuide->getURLsuffix().toLatin1();
     realURLsuffix.append(taskGuide->fillURLArgList(URLParams));
+
+    //A filter given with the request itself (ie. AgaveJobQuery fields) takes priority over the guide's
+    if ((taskGuide->getRequestType() == AgaveRequestType::AGAVE_GET) && (taskGuide->usesResponseFilter())
+            && (!realURLsuffix.contains("?filter=")) && (!realURLsuffix.contains("&filter=")))
+    {
+        realURLsuffix.append(realURLsuffix.contains('?') ? '&' : '?');
+        realURLsuffix.append(taskGuide->getResponseFilterQuery());
+    }
+
     QByteArray clientPostData = taskGuide->fillPostArgList(postParams);
 
     QByteArray * authHeader = NULL;
@@ -973,14 +1594,17 @@ QNetworkReply * AgaveHandler::internalQueryMethod(AgaveTaskGuide * taskGuide, QS
     if ((taskGuide->getRequestType() == AgaveRequestType::AGAVE_POST) || (taskGuide->getRequestType() == AgaveRequestType::AGAVE_PUT))
     {
         //Note: For a put, the post data for this function is used as the put data for the HTTP request
-        qDebug("Post data: %s", qPrintable(clientPostData));
+        if (!taskGuide->isSensitive())
+        {
+            AGAVE_LOG_PAYLOAD("Post data", clientPostData);
+        }
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
                          authHeader, clientPostData);
     }
     else if ((taskGuide->getRequestType() == AgaveRequestType::AGAVE_GET) || (taskGuide->getRequestType() == AgaveRequestType::AGAVE_DELETE))
     {
 
-        qDebug("URL Req: %s", qPrintable(realURLsuffix));
+        qCDebug(agaveRequests, "URL Req: %s", realURLsuffix.constData());
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
                          authHeader);
     }
@@ -994,7 +1618,7 @@ QNetworkReply * AgaveHandler::internalQueryMethod(AgaveTaskGuide * taskGuide, QS
             fileHandle->deleteLater();
             return NULL;
         }
-        qDebug("URL Req: %s", qPrintable(realURLsuffix));
+        qCDebug(agaveRequests, "URL Req: %s", realURLsuffix.constData());
         QByteArray filePostData = fullFileName.toLatin1();
 
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
@@ -1013,7 +1637,7 @@ QNetworkReply * AgaveHandler::internalQueryMethod(AgaveTaskGuide * taskGuide, QS
             return NULL;
         }
         fileHandle->deleteLater();
-        qDebug("URL Req: %s", qPrintable(realURLsuffix));
+        qCDebug(agaveRequests, "URL Req: %s", realURLsuffix.constData());
         QByteArray emptyPostData;
 
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
@@ -1026,14 +1650,20 @@ QNetworkReply * AgaveHandler::internalQueryMethod(AgaveTaskGuide * taskGuide, QS
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
                          authHeader, emptyPostData);
     }
+    else if (taskGuide->getRequestType() == AgaveRequestType::AGAVE_RANGE_DOWNLOAD)
+    {
+        qCDebug(agaveRequests, "URL Req: %s, %s", realURLsuffix.constData(), clientPostData.constData());
+        return finalizeAgaveRequest(taskGuide, realURLsuffix,
+                         authHeader, clientPostData);
+    }
     else if (taskGuide->getRequestType() == AgaveRequestType::AGAVE_PIPE_UPLOAD)
     {
-        qDebug("Post Data: \n%s", qPrintable(clientPostData));
+        AGAVE_LOG_PAYLOAD("Post data", clientPostData);
         QByteArray * uploadData = new QByteArray(clientPostData);
         //TODO: find a way to clean up the uploadData when no longer needed
         QBuffer * pipedData = new QBuffer(uploadData);
         pipedData->open(QBuffer::ReadOnly);
-        qDebug("URL Req: %s", qPrintable(realURLsuffix));
+        qCDebug(agaveRequests, "URL Req: %s", realURLsuffix.constData());
         QByteArray filePostData = "JSON";
 
         return finalizeAgaveRequest(taskGuide, realURLsuffix,
@@ -1079,10 +1709,25 @@ QNetworkReply * AgaveHandler::finalizeAgaveRequest(AgaveTaskGuide * theGuide, QS
     // qt.network.ssl.warning=false
     clientRequest->setSslConfiguration(SSLoptions);
 
-    qDebug("%s", qPrintable(clientRequest->url().url()));
+    if (theGuide->isConditional() && (theGuide->getRequestType() == AgaveRequestType::AGAVE_GET))
+    {
+        conditionalCache.addValidators(clientRequest);
+    }
+
+    if (issuingPrefetch)
+    {
+        clientRequest->setPriority(QNetworkRequest::LowPriority);
+    }
+
+    qCDebug(agaveRequests, "%s", qPrintable(clientRequest->url().toDisplayString()));
+
+    if (theGuide->getRequestType() == AgaveRequestType::AGAVE_RANGE_DOWNLOAD)
+    {
+        clientRequest->setRawHeader(QByteArray("Range"), postData);
+    }
 
     if ((theGuide->getRequestType() == AgaveRequestType::AGAVE_GET) || (theGuide->getRequestType() == AgaveRequestType::AGAVE_DOWNLOAD)
-            || (theGuide->getRequestType() == AgaveRequestType::AGAVE_PIPE_DOWNLOAD))
+            || (theGuide->getRequestType() == AgaveRequestType::AGAVE_PIPE_DOWNLOAD) || (theGuide->getRequestType() == AgaveRequestType::AGAVE_RANGE_DOWNLOAD))
     {
         clientReply = networkHandle.get(*clientRequest);
     }
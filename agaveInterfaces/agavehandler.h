@@ -37,6 +37,10 @@
 #define AGAVEHANDLER_H
 
 #include "../remotedatainterface.h"
+#include "agavelistingcache.h"
+#include "agavemetadatastore.h"
+#include "agaveconditionalcache.h"
+#include "agavefilesearchindex.h"
 
 #include <QtGlobal>
 #include <QObject>
@@ -44,6 +48,8 @@
 #include <QNetworkReply>
 #include <QSslConfiguration>
 #include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
 #include <QFile>
 #include <QBuffer>
 #include <QHttpMultiPart>
@@ -52,12 +58,24 @@
 #include <QStringList>
 #include <QList>
 #include <QMultiMap>
+#include <QHash>
+#include <QTimer>
 
-enum class AgaveRequestType {AGAVE_GET, AGAVE_POST, AGAVE_DELETE, AGAVE_UPLOAD, AGAVE_PIPE_UPLOAD, AGAVE_PIPE_DOWNLOAD, AGAVE_DOWNLOAD, AGAVE_PUT, AGAVE_NONE, AGAVE_APP};
+enum class AgaveRequestType {AGAVE_GET, AGAVE_POST, AGAVE_DELETE, AGAVE_UPLOAD, AGAVE_PIPE_UPLOAD, AGAVE_PIPE_DOWNLOAD, AGAVE_DOWNLOAD, AGAVE_PUT, AGAVE_NONE, AGAVE_APP, AGAVE_RANGE_DOWNLOAD};
 
 class AgaveTaskGuide;
 class AgaveTaskReply;
 class AgaveLongRunning;
+class AgaveJobQuery;
+class AgaveJobWatcher;
+class AgaveNotificationListener;
+class AgaveJobBatchReply;
+class AgaveSweepReply;
+class AgaveParameterSweep;
+class AgaveStagingPipeline;
+class AgaveJobHarvester;
+class AgaveTreeWalker;
+class AgaveFileFollower;
 
 class AgaveHandler : public RemoteDataInterface
 {
@@ -93,6 +111,8 @@ public:
     virtual RemoteDataReply * uploadBuffer(QString location, QByteArray fileData);
     virtual RemoteDataReply * downloadFile(QString localDest, QString remoteName);
     virtual RemoteDataReply * downloadBuffer(QString remoteName);
+    virtual RemoteDataReply * readRemoteRange(QString remoteName, qint64 offset, qint64 length = -1);
+    virtual RemoteDataReply * readRemoteTail(QString remoteName, qint64 length);
 
     virtual RemoteDataReply * runRemoteJob(QString jobName, QMultiMap<QString, QString> jobParameters, QString remoteWorkingDir);
 
@@ -114,15 +134,123 @@ public:
     //the job parameters are a list matching the inputs/parameters given by parameterList and inputList
     //and the remoteWorkingDir will be used as a input/parameter named in remoteDirParameter (optional)
 
+    //Submits many jobs of one app, at most maxInFlight at a time
+    //The app's info is looked up once, and each job's JSON is built from one template
+    //The batch reply gives each job's ID as it is submitted, see AgaveJobBatchReply
+    AgaveJobBatchReply * runRemoteJobs(QString jobName, QList<QMultiMap<QString, QString> > jobList, QString remoteWorkingDir, int maxInFlight = 8);
+
+    //Submits one job per point of the sweep, generating each point only when it is submitted
+    //All sweep parameters must be registered for the app. With a checkpoint file, a sweep
+    //run again with the same file skips the points already submitted.
+    //submitInterval is the least time, in milliseconds, between two submissions.
+    AgaveSweepReply * runParameterSweep(QString jobName, AgaveParameterSweep theSweep, QString remoteWorkingDir,
+                                        QString checkpointFile = "", int maxInFlight = 8, int submitInterval = 0);
+
+    //Parts of runRemoteJob, used by batch submission:
+    //The template has everything but the inputs and parameters, it is empty if jobName is not a registered app
+    QJsonObject getAgaveJobTemplate(QString jobName);
+    RemoteDataReply * runRemoteJobFromTemplate(QString jobName, const QJsonObject &jobTemplate, QMultiMap<QString, QString> jobParameters, QString remoteWorkingDir);
+
+    //Uploads job inputs, with uploads shared across jobs, and starts each job once its inputs are uploaded
+    //Owned by the handler, see AgaveStagingPipeline
+    AgaveStagingPipeline * createStagingPipeline(int maxUploads = 4);
+    //Agave URL of a file on this handler's storage system, as used for job inputs
+    QString getAgaveFileURL(QString remotePath);
+    QString getStorageSystem();
+
+    //Follows a growing remote file, like tail -f, see AgaveFileFollower
+    //Owned by the handler, delete it to stop following
+    AgaveFileFollower * followRemoteFile(QString remoteName, qint64 startOffset = 0);
+
+    //Downloads job outputs when jobs finish, see AgaveJobHarvester
+    //Owned by the handler
+    AgaveJobHarvester * getJobHarvester();
+
+    //Recursive operations on a remote folder, listing many folders at once, see AgaveTreeWalker
+    //Results stream from the walker's signals, and the walker deletes itself when complete
+    AgaveTreeWalker * walkRemoteTree(QString rootPath, int maxInFlight = 8);
+    //Signals only the entries whose name or path below rootPath matches the wildcard pattern
+    AgaveTreeWalker * findRemoteFiles(QString rootPath, QString wildcardPattern, int maxInFlight = 8);
+    //Walks the tree, then deletes rootPath, with its totals being what was deleted
+    AgaveTreeWalker * deleteRemoteTree(QString rootPath, int maxInFlight = 8);
+
+    //Job list restricted by status, app, creation time, page and fields, see AgaveJobQuery
+    //Replies with the same haveJobList signal as getListOfJobs()
+    RemoteDataReply * getListOfJobs(AgaveJobQuery jobQuery);
+
+    //Watches job states with batched, adaptive polling, see AgaveJobWatcher
+    //Owned by the handler, stops watching on logout
+    AgaveJobWatcher * getJobWatcher();
+
+    //Job notifications: jobs started with runRemoteJob ask Agave to call back a local listener,
+    //reachable by the tenant at publicHost, and are watched by the job watcher from those events.
+    //If no event arrives within pushTimeout, the watcher polls the job instead.
+    bool enableJobNotifications(QString publicHost, quint16 port = 0, int pushTimeoutMsecs = 60000);
+    void disableJobNotifications();
+    AgaveNotificationListener * getNotificationListener();
+
+    //Called by task replies when a job has been submitted
+    void jobSubmitted(QString jobID, QString jobState);
+
     //For debugging purposes, to retrive the list of available Agave Apps:
     AgaveTaskReply * getAgaveAppList();
+
+    //As remoteLS, but always asks the remote system, never the listing cache or metadata store
+    //For work which must see the folder as it is now, such as harvests and recursive deletes
+    RemoteDataReply * remoteLSFresh(QString dirPath);
+
+    //Listing cache: remoteLS of a recently listed folder is answered without a network request
+    //Disabled (time to live 0) by default. File operations done through this handler keep it up to date.
+    void setListingCacheTTL(int msecs);
+    AgaveListingCache * getListingCache();
+
+    //Called by task replies with their results, to keep the listing cache current:
+    //Only foreground listings direct prefetch. Background listings (tree walks, harvests) are
+    //tagged with the "background" task parameter, prefetch listings with "prefetch".
+    void cacheListingResult(QString dirPath, FileListing newListing, bool fromPrefetch = false, bool fromBackground = false);
+    void applyFileOperationResult(AgaveTaskReply * agaveReply, FileMetaData * newFileData);
+    void cacheJobListResult(QString jobQuery, QList<RemoteJobData> newJobList);
+
+    //Validators and results of listings and job details, for conditional requests
+    AgaveConditionalCache * getConditionalCache();
+
+    //Prefetch: after a listing, the first childLimit subfolders not already cached are listed
+    //into the listing cache, one at a time, only while no other request is pending.
+    //At most requestsPerSec are sent, and prefetching stops for the current folder once
+    //entryBudget entries have been fetched. childLimit 0 (the default) disables it.
+    //Needs the listing cache, see setListingCacheTTL.
+    void setListingPrefetch(int childLimit, int requestsPerSec = 2, int entryBudget = 2000);
+
+    //Metadata store: listings and the job list are saved to disk, in the given folder,
+    //and shown at once in later sessions while a fresh copy is fetched in the background.
+    //Opened at login, the file is per user and storage system.
+    void enableMetadataStore(QString storeDir);
+    AgaveMetadataStore * getMetadataStore();
+
+    //Search index: every listing is indexed by name, for substring and wildcard searches without
+    //the network, see AgaveFileSearchIndex. Disabled by default. Cleared at logout.
+    void setSearchIndexEnabled(bool enable);
+    AgaveFileSearchIndex * getSearchIndex();
+
 signals:
     void finishedAllTasks();
 
+    //A cached listing was updated in place by a file operation
+    void remoteListingChanged(QString dirPath, FileListing newListing);
+    //A file operation changed a folder whose listing is not cached, so any copy of it is out of date
+    void remoteListingInvalidated(QString dirPath);
+    //A job list from the metadata store was out of date, this is the fresh list
+    void remoteJobListChanged(QList<RemoteJobData> newJobList);
+
 private slots:
     void handleInternalTask(AgaveTaskReply *agaveReply, QNetworkReply * rawReply);
     void finishedOneTask(QNetworkReply *reply);
 
+    void revalidatedListing(RequestState replyState, FileListing newListing);
+    void revalidatedJobList(RequestState replyState, QList<RemoteJobData> newJobList);
+
+    void issuePrefetch();
+
 private:
     AgaveTaskReply * performAgaveQuery(QString queryName, QObject * parentReq = NULL);
     AgaveTaskReply * performAgaveQuery(QString queryName, QString param1, QObject * parentReq = NULL);
@@ -141,6 +269,8 @@ private:
 
     QString getPathReletiveToCWD(QString inputPath);
 
+    void schedulePrefetch(QString dirPath, FileListing dirListing);
+
     QNetworkAccessManager networkHandle;
     QSslConfiguration SSLoptions;
     const QString tenantURL = "https://agave.designsafe-ci.org";
@@ -160,6 +290,31 @@ private:
 
     QMap<QString, AgaveTaskGuide*> validTaskList;
 
+    AgaveListingCache listingCache;
+
+    AgaveConditionalCache conditionalCache;
+
+    AgaveFileSearchIndex searchIndex;
+
+    AgaveMetadataStore metadataStore;
+    QString metadataStoreDir;
+    //What was shown from the store, for the listings being fetched again
+    QHash<QString, FileListing> revalidatingListings;
+    QList<RemoteJobData> revalidatingJobList;
+    bool jobListRevalidating = false;
+
+    AgaveJobWatcher * jobWatcher = NULL;
+    AgaveNotificationListener * notificationListener = NULL;
+    AgaveJobHarvester * jobHarvester = NULL;
+    int notificationTimeout = 60000;
+
+    QTimer prefetchTimer;
+    QStringList prefetchQueue;
+    int prefetchChildLimit = 0;
+    int prefetchEntryBudget = 2000;
+    int prefetchEntriesUsed = 0;
+    bool issuingPrefetch = false;
+
     QString pwd = "";
 
     int pendingRequestCount = 0;
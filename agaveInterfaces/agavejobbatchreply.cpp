@@ -0,0 +1,187 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavejobbatchreply.h"
+#include "agavehandler.h"
+#include "agavejsonkeypath.h"
+#include "agavelogging.h"
+
+AgaveJobBatchReply::AgaveJobBatchReply(AgaveHandler * theManager, QString jobName, QJsonObject jobTemplate, QString remoteWorkingDir, int maxInFlight, QObject * parent) : RemoteDataReply(parent)
+{
+    myManager = theManager;
+    myJobName = jobName;
+    myJobTemplate = jobTemplate;
+    myRemoteWorkingDir = remoteWorkingDir;
+    myMaxInFlight = qMax(maxInFlight, 1);
+
+    taskParamList.insert("jobName", jobName);
+    taskParamList.insert("remoteWorkingDir", remoteWorkingDir);
+}
+
+QMultiMap<QString, QString> * AgaveJobBatchReply::getTaskParamList()
+{
+    return &taskParamList;
+}
+
+void AgaveJobBatchReply::setJobList(QList<QMultiMap<QString, QString> > newJobList)
+{
+    pendingJobs = newJobList;
+    nextJobIndex = 0;
+}
+
+void AgaveJobBatchReply::startBatch()
+{
+    //Started from the event loop, so the caller can connect signals first
+    QTimer::singleShot(0, this, SLOT(submitMoreJobs()));
+}
+
+void AgaveJobBatchReply::cancelBatch()
+{
+    batchCancelled = true;
+    if (inFlightJobs.isEmpty())
+    {
+        finishBatch();
+    }
+}
+
+int AgaveJobBatchReply::getSubmittedCount()
+{
+    return submittedCount;
+}
+
+int AgaveJobBatchReply::getFailedCount()
+{
+    return failedCount;
+}
+
+QStringList AgaveJobBatchReply::getJobIDs()
+{
+    return jobIDs;
+}
+
+bool AgaveJobBatchReply::takeNextJob(int * jobIndex, QMultiMap<QString, QString> * jobParameters)
+{
+    if (nextJobIndex >= pendingJobs.size()) return false;
+
+    *jobIndex = nextJobIndex;
+    *jobParameters = pendingJobs.at(nextJobIndex);
+    //The parameters are not needed once submitted
+    pendingJobs[nextJobIndex] = QMultiMap<QString, QString>();
+    nextJobIndex++;
+    return true;
+}
+
+bool AgaveJobBatchReply::hasMoreJobs()
+{
+    return (nextJobIndex < pendingJobs.size());
+}
+
+void AgaveJobBatchReply::recordJobResult(int jobIndex, RequestState replyState, QString jobID)
+{
+    while (jobIDs.size() <= jobIndex)
+    {
+        jobIDs.append(QString());
+    }
+    jobIDs[jobIndex] = jobID;
+
+    if (replyState == RequestState::GOOD)
+    {
+        submittedCount++;
+    }
+    else
+    {
+        failedCount++;
+    }
+    emit jobSubmitResult(jobIndex, replyState, jobID);
+}
+
+void AgaveJobBatchReply::submitMoreJobs()
+{
+    if (batchFinished) return;
+
+    int jobIndex;
+    QMultiMap<QString, QString> jobParameters;
+    while (!batchCancelled && (inFlightJobs.size() < myMaxInFlight) && takeNextJob(&jobIndex, &jobParameters))
+    {
+        RemoteDataReply * jobReply = myManager->runRemoteJobFromTemplate(myJobName, myJobTemplate, jobParameters, myRemoteWorkingDir);
+        if (jobReply == NULL)
+        {
+            qCWarning(agaveRequests, "Job %d of batch could not be submitted", jobIndex);
+            recordJobResult(jobIndex, RequestState::FAIL, QString());
+            continue;
+        }
+        inFlightJobs.insert(jobReply, jobIndex);
+        QObject::connect(jobReply, SIGNAL(haveJobResult(RequestState,QJsonDocument)),
+                         this, SLOT(oneJobDone(RequestState,QJsonDocument)));
+    }
+
+    //A subclass may hold jobs back for a while, the batch is only over once there are none left
+    if (inFlightJobs.isEmpty() && (batchCancelled || !hasMoreJobs()))
+    {
+        finishBatch();
+    }
+}
+
+void AgaveJobBatchReply::oneJobDone(RequestState replyState, QJsonDocument rawJobReply)
+{
+    static const AgaveJSONKeyPath jobIDPath({"result", "id"});
+
+    auto itr = inFlightJobs.find(QObject::sender());
+    if (itr == inFlightJobs.end()) return;
+    int jobIndex = *itr;
+    inFlightJobs.erase(itr);
+
+    QString jobID;
+    if (replyState == RequestState::GOOD)
+    {
+        jobID = jobIDPath.retriveValue(rawJobReply.object()).toString();
+        if (jobID.isEmpty())
+        {
+            replyState = RequestState::FAIL;
+        }
+    }
+    recordJobResult(jobIndex, replyState, jobID);
+
+    submitMoreJobs();
+}
+
+void AgaveJobBatchReply::finishBatch()
+{
+    if (batchFinished) return;
+    batchFinished = true;
+
+    this->deleteLater();
+    emit batchComplete((failedCount == 0) ? RequestState::GOOD : RequestState::FAIL, jobIDs);
+}
@@ -0,0 +1,116 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEJOBBATCHREPLY_H
+#define AGAVEJOBBATCHREPLY_H
+
+#include "../remotedatainterface.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QMultiMap>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QTimer>
+
+class AgaveHandler;
+
+//Reply for AgaveHandler::runRemoteJobs
+//Submits jobs from one template, with at most maxInFlight submissions pending at once.
+//jobSubmitResult is emitted for each job as its submission completes (not in order),
+//and batchComplete once all have, after which the reply deletes itself.
+//Subclasses can give jobs some other way by overriding takeNextJob and hasMoreJobs.
+class AgaveJobBatchReply : public RemoteDataReply
+{
+    Q_OBJECT
+public:
+    explicit AgaveJobBatchReply(AgaveHandler * theManager, QString jobName, QJsonObject jobTemplate, QString remoteWorkingDir, int maxInFlight, QObject * parent = 0);
+
+    virtual QMultiMap<QString, QString> * getTaskParamList();
+
+    void setJobList(QList<QMultiMap<QString, QString> > newJobList);
+    void startBatch();
+    //Jobs not yet submitted are dropped, pending submissions still complete
+    void cancelBatch();
+
+    int getSubmittedCount();
+    int getFailedCount();
+    //By job index, empty for jobs which failed or are not submitted yet
+    QStringList getJobIDs();
+
+signals:
+    void jobSubmitResult(int jobIndex, RequestState replyState, QString jobID);
+    void batchComplete(RequestState replyState, QStringList jobIDs);
+
+protected:
+    //Gives the next job to submit, false if there are no more
+    virtual bool takeNextJob(int * jobIndex, QMultiMap<QString, QString> * jobParameters);
+    //False once takeNextJob will never give another job
+    virtual bool hasMoreJobs();
+    virtual void recordJobResult(int jobIndex, RequestState replyState, QString jobID);
+
+    AgaveHandler * myManager = NULL;
+    bool batchCancelled = false;
+
+protected slots:
+    void submitMoreJobs();
+
+private slots:
+    void oneJobDone(RequestState replyState, QJsonDocument rawJobReply);
+
+private:
+    void finishBatch();
+
+    QString myJobName;
+    QJsonObject myJobTemplate;
+    QString myRemoteWorkingDir;
+    int myMaxInFlight;
+
+    QList<QMultiMap<QString, QString> > pendingJobs;
+    int nextJobIndex = 0;
+
+    QHash<QObject *, int> inFlightJobs;
+    QStringList jobIDs;
+    int submittedCount = 0;
+    int failedCount = 0;
+    bool batchFinished = false;
+
+    QMultiMap<QString, QString> taskParamList;
+};
+
+#endif // AGAVEJOBBATCHREPLY_H
@@ -0,0 +1,418 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavejobharvester.h"
+#include "agavehandler.h"
+#include "agavejobwatcher.h"
+#include "agavelistingcache.h"
+#include "agavelogging.h"
+
+#include "../filemetadata.h"
+
+AgaveJobHarvester::AgaveJobHarvester(AgaveHandler * theManager) : QObject((QObject *)theManager)
+{
+    myManager = theManager;
+    QObject::connect(myManager->getJobWatcher(), SIGNAL(jobWatchEnded(QString,QString)),
+                     this, SLOT(watchedJobEnded(QString,QString)));
+}
+
+void AgaveJobHarvester::setMaxInFlight(int maxRequests)
+{
+    maxInFlight = qMax(maxRequests, 1);
+    startTasks();
+}
+
+void AgaveJobHarvester::harvestJob(QString jobID, QString localDir, QStringList includePatterns, QStringList excludePatterns)
+{
+    if (activeHarvests.contains(jobID)) return;
+
+    if (!QDir(localDir).mkpath("."))
+    {
+        qCWarning(agaveReplies, "Unable to create harvest folder: %s", qPrintable(localDir));
+        emit harvestComplete(jobID, RequestState::FAIL, 0);
+        return;
+    }
+
+    RemoteDataReply * detailsReply = myManager->getJobDetails(jobID);
+    if (detailsReply == NULL)
+    {
+        emit harvestComplete(jobID, RequestState::NO_CONNECT, 0);
+        return;
+    }
+
+    ActiveHarvest newHarvest;
+    newHarvest.spec = makeSpec(localDir, includePatterns, excludePatterns);
+    newHarvest.tasksLeft = 0;
+    newHarvest.fileCount = 0;
+    newHarvest.failed = false;
+    newHarvest.manifest = readManifest(localDir);
+    activeHarvests.insert(jobID, newHarvest);
+
+    inFlightDetails.insert(detailsReply, jobID);
+    QObject::connect(detailsReply, SIGNAL(haveJobDetailsResult(RequestState,RemoteJobData)),
+                     this, SLOT(gotJobDetails(RequestState,RemoteJobData)));
+}
+
+void AgaveJobHarvester::setAutoHarvest(QString jobID, QString localDir, QStringList includePatterns, QStringList excludePatterns)
+{
+    autoHarvests.insert(jobID, makeSpec(localDir, includePatterns, excludePatterns));
+
+    AgaveJobWatcher * theWatcher = myManager->getJobWatcher();
+    if (!theWatcher->isWatching(jobID))
+    {
+        theWatcher->watchJob(jobID);
+    }
+}
+
+void AgaveJobHarvester::cancelAutoHarvest(QString jobID)
+{
+    autoHarvests.remove(jobID);
+}
+
+bool AgaveJobHarvester::isHarvesting(QString jobID)
+{
+    return activeHarvests.contains(jobID);
+}
+
+QString AgaveJobHarvester::getManifestFileName()
+{
+    return QString(".agave-manifest.sha256");
+}
+
+void AgaveJobHarvester::watchedJobEnded(QString jobID, QString finalState)
+{
+    auto itr = autoHarvests.find(jobID);
+    if (itr == autoHarvests.end()) return;
+    HarvestSpec theSpec = *itr;
+    autoHarvests.erase(itr);
+
+    if (finalState != "FINISHED")
+    {
+        qCDebug(agaveReplies, "Job %s ended as %s, nothing to harvest", qPrintable(jobID), qPrintable(finalState));
+        emit harvestComplete(jobID, RequestState::FAIL, 0);
+        return;
+    }
+
+    harvestJob(jobID, theSpec.localDir, theSpec.includePatterns, theSpec.excludePatterns);
+}
+
+void AgaveJobHarvester::gotJobDetails(RequestState replyState, RemoteJobData jobData)
+{
+    auto itr = inFlightDetails.find(QObject::sender());
+    if (itr == inFlightDetails.end()) return;
+    QString jobID = *itr;
+    inFlightDetails.erase(itr);
+
+    auto harvestItr = activeHarvests.find(jobID);
+    if (harvestItr == activeHarvests.end()) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        activeHarvests.erase(harvestItr);
+        emit harvestComplete(jobID, replyState, 0);
+        return;
+    }
+
+    QString archivePath = jobData.getArchivePath();
+    if (archivePath.isEmpty())
+    {
+        //Agave's default archive folder
+        archivePath = QString("/%1/archive/jobs/job-%2").arg(myManager->getUserName(), jobID);
+    }
+    if (!jobData.getArchiveSystem().isEmpty() && (jobData.getArchiveSystem() != myManager->getStorageSystem()))
+    {
+        qCWarning(agaveReplies, "Job %s is archived on %s, which this handler cannot read", qPrintable(jobID), qPrintable(jobData.getArchiveSystem()));
+        activeHarvests.erase(harvestItr);
+        emit harvestComplete(jobID, RequestState::FAIL, 0);
+        return;
+    }
+    harvestItr->archiveRoot = AgaveListingCache::getCacheKey(archivePath);
+
+    HarvestTask rootListing;
+    rootListing.jobID = jobID;
+    rootListing.isListing = true;
+    rootListing.remotePath = harvestItr->archiveRoot;
+    rootListing.fileSize = 0;
+    queueTask(rootListing);
+    startTasks();
+}
+
+void AgaveJobHarvester::gotListing(RequestState replyState, FileListing dirListing)
+{
+    auto itr = inFlightTasks.find(QObject::sender());
+    if (itr == inFlightTasks.end()) return;
+    HarvestTask doneTask = *itr;
+    inFlightTasks.erase(itr);
+
+    auto harvestItr = activeHarvests.find(doneTask.jobID);
+    if ((replyState != RequestState::GOOD) || (harvestItr == activeHarvests.end()))
+    {
+        taskDone(doneTask, true);
+        return;
+    }
+
+    QString dirKey = AgaveListingCache::getCacheKey(doneTask.remotePath);
+    for (auto entryItr = dirListing.constBegin(); entryItr != dirListing.constEnd(); ++entryItr)
+    {
+        FileListingEntry anEntry = *entryItr;
+        QString entryKey = AgaveListingCache::getCacheKey(anEntry.getFullPath());
+        //Agave lists the folder itself as "."
+        if (entryKey == dirKey) continue;
+
+        HarvestTask newTask;
+        newTask.jobID = doneTask.jobID;
+        newTask.remotePath = entryKey;
+        newTask.relativePath = entryKey.mid(harvestItr->archiveRoot.size() + 1);
+        newTask.fileSize = anEntry.getSize();
+        newTask.isListing = (anEntry.getFileType() == FileType::DIR);
+
+        if (newTask.isListing)
+        {
+            queueTask(newTask);
+        }
+        else if (anEntry.getFileType() == FileType::FILE)
+        {
+            if (!matchesSpec(harvestItr->spec, newTask.relativePath, anEntry.getFileName())) continue;
+
+            QString localPath = QDir(harvestItr->spec.localDir).filePath(newTask.relativePath);
+            QFileInfo localInfo(localPath);
+            if (localInfo.exists() && (localInfo.size() == newTask.fileSize))
+            {
+                harvestItr->fileCount++;
+                fileReady(newTask, localPath, false);
+                continue;
+            }
+            //The download refuses to overwrite, an incomplete copy is removed first
+            if (localInfo.exists())
+            {
+                QFile::remove(localPath);
+            }
+            QDir().mkpath(localInfo.absolutePath());
+
+            queueTask(newTask);
+        }
+    }
+    taskDone(doneTask, false);
+}
+
+void AgaveJobHarvester::gotDownload(RequestState replyState)
+{
+    auto itr = inFlightTasks.find(QObject::sender());
+    if (itr == inFlightTasks.end()) return;
+    HarvestTask doneTask = *itr;
+    inFlightTasks.erase(itr);
+
+    auto harvestItr = activeHarvests.find(doneTask.jobID);
+    if ((replyState == RequestState::GOOD) && (harvestItr != activeHarvests.end()))
+    {
+        harvestItr->fileCount++;
+        fileReady(doneTask, QDir(harvestItr->spec.localDir).filePath(doneTask.relativePath), true);
+    }
+    taskDone(doneTask, (replyState != RequestState::GOOD));
+}
+
+AgaveJobHarvester::HarvestSpec AgaveJobHarvester::makeSpec(QString localDir, QStringList includePatterns, QStringList excludePatterns)
+{
+    HarvestSpec ret;
+    ret.localDir = localDir;
+    ret.includePatterns = includePatterns;
+    ret.excludePatterns = excludePatterns;
+    for (const QString &aPattern : includePatterns)
+    {
+        ret.includeList.append(QRegularExpression(QRegularExpression::anchoredPattern(QRegularExpression::wildcardToRegularExpression(aPattern))));
+    }
+    for (const QString &aPattern : excludePatterns)
+    {
+        ret.excludeList.append(QRegularExpression(QRegularExpression::anchoredPattern(QRegularExpression::wildcardToRegularExpression(aPattern))));
+    }
+    return ret;
+}
+
+bool AgaveJobHarvester::matchesSpec(const HarvestSpec &theSpec, const QString &relativePath, const QString &fileName)
+{
+    for (const QRegularExpression &aPattern : theSpec.excludeList)
+    {
+        if (aPattern.match(relativePath).hasMatch() || aPattern.match(fileName).hasMatch()) return false;
+    }
+    if (theSpec.includeList.isEmpty()) return true;
+
+    for (const QRegularExpression &aPattern : theSpec.includeList)
+    {
+        if (aPattern.match(relativePath).hasMatch() || aPattern.match(fileName).hasMatch()) return true;
+    }
+    return false;
+}
+
+void AgaveJobHarvester::queueTask(HarvestTask newTask)
+{
+    auto harvestItr = activeHarvests.find(newTask.jobID);
+    if (harvestItr == activeHarvests.end()) return;
+
+    harvestItr->tasksLeft++;
+    //Listings first, so the whole tree is known early and downloads keep the window full
+    if (newTask.isListing)
+    {
+        taskQueue.prepend(newTask);
+    }
+    else
+    {
+        taskQueue.append(newTask);
+    }
+}
+
+void AgaveJobHarvester::startTasks()
+{
+    while (!taskQueue.isEmpty() && (inFlightTasks.size() < maxInFlight))
+    {
+        HarvestTask nextTask = taskQueue.takeFirst();
+        auto harvestItr = activeHarvests.find(nextTask.jobID);
+        if (harvestItr == activeHarvests.end()) continue;
+
+        RemoteDataReply * taskReply = NULL;
+        if (nextTask.isListing)
+        {
+            //Cached listings may be from before the job finished archiving
+            taskReply = myManager->remoteLSFresh(nextTask.remotePath);
+            if (taskReply != NULL)
+            {
+                taskReply->getTaskParamList()->insert("background", "true");
+                QObject::connect(taskReply, SIGNAL(haveListingResult(RequestState,FileListing)),
+                                 this, SLOT(gotListing(RequestState,FileListing)));
+            }
+        }
+        else
+        {
+            QString localPath = QDir(harvestItr->spec.localDir).filePath(nextTask.relativePath);
+            taskReply = myManager->downloadFile(localPath, nextTask.remotePath);
+            if (taskReply != NULL)
+            {
+                QObject::connect(taskReply, SIGNAL(haveDownloadReply(RequestState)),
+                                 this, SLOT(gotDownload(RequestState)));
+            }
+        }
+
+        if (taskReply == NULL)
+        {
+            taskDone(nextTask, true);
+            continue;
+        }
+        inFlightTasks.insert(taskReply, nextTask);
+    }
+}
+
+void AgaveJobHarvester::taskDone(const HarvestTask &doneTask, bool taskFailed)
+{
+    auto harvestItr = activeHarvests.find(doneTask.jobID);
+    if (harvestItr != activeHarvests.end())
+    {
+        if (taskFailed)
+        {
+            qCWarning(agaveReplies, "Harvest of %s failed for %s", qPrintable(doneTask.jobID), qPrintable(doneTask.remotePath));
+            harvestItr->failed = true;
+        }
+        harvestItr->tasksLeft--;
+        if (harvestItr->tasksLeft <= 0)
+        {
+            finishHarvest(doneTask.jobID);
+        }
+    }
+    startTasks();
+}
+
+void AgaveJobHarvester::fileReady(const HarvestTask &doneTask, QString localPath, bool newDownload)
+{
+    auto harvestItr = activeHarvests.find(doneTask.jobID);
+    if (harvestItr == activeHarvests.end()) return;
+
+    //A file kept from an earlier harvest keeps its manifest entry
+    QByteArray fileHash = harvestItr->manifest.value(doneTask.relativePath);
+    if (fileHash.isEmpty() || newDownload)
+    {
+        fileHash = hashLocalFile(localPath);
+        harvestItr->manifest.insert(doneTask.relativePath, fileHash);
+    }
+    emit fileHarvested(doneTask.jobID, doneTask.remotePath, localPath, fileHash);
+}
+
+void AgaveJobHarvester::finishHarvest(QString jobID)
+{
+    ActiveHarvest doneHarvest = activeHarvests.take(jobID);
+    if (!writeManifest(doneHarvest.spec.localDir, doneHarvest.manifest))
+    {
+        qCWarning(agaveReplies, "Unable to write harvest manifest in %s", qPrintable(doneHarvest.spec.localDir));
+    }
+    emit harvestComplete(jobID, doneHarvest.failed ? RequestState::FAIL : RequestState::GOOD, doneHarvest.fileCount);
+}
+
+QByteArray AgaveJobHarvester::hashLocalFile(QString localPath)
+{
+    QFile localFile(localPath);
+    if (!localFile.open(QIODevice::ReadOnly)) return QByteArray();
+
+    QCryptographicHash fileHash(QCryptographicHash::Sha256);
+    fileHash.addData(&localFile);
+    return fileHash.result().toHex();
+}
+
+QMap<QString, QByteArray> AgaveJobHarvester::readManifest(QString localDir)
+{
+    QMap<QString, QByteArray> ret;
+    QFile manifestFile(QDir(localDir).filePath(getManifestFileName()));
+    if (!manifestFile.open(QIODevice::ReadOnly | QIODevice::Text)) return ret;
+
+    while (!manifestFile.atEnd())
+    {
+        QByteArray aLine = manifestFile.readLine().trimmed();
+        int splitPos = aLine.indexOf("  ");
+        if (splitPos <= 0) continue;
+        ret.insert(QString::fromUtf8(aLine.mid(splitPos + 2)), aLine.left(splitPos));
+    }
+    return ret;
+}
+
+bool AgaveJobHarvester::writeManifest(QString localDir, const QMap<QString, QByteArray> &manifest)
+{
+    QFile manifestFile(QDir(localDir).filePath(getManifestFileName()));
+    if (!manifestFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+
+    for (auto itr = manifest.cbegin(); itr != manifest.cend(); itr++)
+    {
+        manifestFile.write(itr.value());
+        manifestFile.write("  ");
+        manifestFile.write(itr.key().toUtf8());
+        manifestFile.write("\n");
+    }
+    return true;
+}
@@ -0,0 +1,146 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEJOBHARVESTER_H
+#define AGAVEJOBHARVESTER_H
+
+#include "../remotedatainterface.h"
+#include "../filelisting.h"
+#include "../remotejobdata.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QMap>
+#include <QList>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <QCryptographicHash>
+
+class AgaveHandler;
+
+//Downloads the outputs of finished jobs to a local folder
+//The job's archive folder is found with getJobDetails, listed recursively with remoteLSFresh,
+//and the files matching the include patterns (all, if none) and no exclude pattern are downloaded.
+//Patterns are wildcards, matched against the path in the archive folder and the file name.
+//Files already present locally with the remote size are not downloaded again.
+//A SHA-256 manifest of the harvested files, in sha256sum format, is kept in the local folder.
+class AgaveJobHarvester : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveJobHarvester(AgaveHandler * theManager);
+
+    //Downloads and listings of all harvests share this limit
+    void setMaxInFlight(int maxRequests);
+
+    void harvestJob(QString jobID, QString localDir, QStringList includePatterns = QStringList(), QStringList excludePatterns = QStringList());
+    //Harvests the job when the job watcher sees it finish
+    void setAutoHarvest(QString jobID, QString localDir, QStringList includePatterns = QStringList(), QStringList excludePatterns = QStringList());
+    void cancelAutoHarvest(QString jobID);
+
+    bool isHarvesting(QString jobID);
+
+    static QString getManifestFileName();
+
+signals:
+    void fileHarvested(QString jobID, QString remotePath, QString localPath, QByteArray sha256);
+    //fileCount counts files downloaded or already present
+    void harvestComplete(QString jobID, RequestState replyState, int fileCount);
+
+private slots:
+    void watchedJobEnded(QString jobID, QString finalState);
+    void gotJobDetails(RequestState replyState, RemoteJobData jobData);
+    void gotListing(RequestState replyState, FileListing dirListing);
+    void gotDownload(RequestState replyState);
+
+private:
+    struct HarvestSpec
+    {
+        QString localDir;
+        QStringList includePatterns;
+        QStringList excludePatterns;
+        QList<QRegularExpression> includeList;
+        QList<QRegularExpression> excludeList;
+    };
+
+    struct ActiveHarvest
+    {
+        HarvestSpec spec;
+        QString archiveRoot;
+        int tasksLeft;
+        int fileCount;
+        bool failed;
+        QMap<QString, QByteArray> manifest;
+    };
+
+    struct HarvestTask
+    {
+        QString jobID;
+        bool isListing;
+        QString remotePath;
+        QString relativePath;
+        qint64 fileSize;
+    };
+
+    HarvestSpec makeSpec(QString localDir, QStringList includePatterns, QStringList excludePatterns);
+    bool matchesSpec(const HarvestSpec &theSpec, const QString &relativePath, const QString &fileName);
+
+    void queueTask(HarvestTask newTask);
+    void startTasks();
+    void taskDone(const HarvestTask &doneTask, bool taskFailed);
+    void fileReady(const HarvestTask &doneTask, QString localPath, bool newDownload);
+    void finishHarvest(QString jobID);
+
+    static QByteArray hashLocalFile(QString localPath);
+    static QMap<QString, QByteArray> readManifest(QString localDir);
+    static bool writeManifest(QString localDir, const QMap<QString, QByteArray> &manifest);
+
+    AgaveHandler * myManager = NULL;
+    int maxInFlight = 4;
+
+    QHash<QString, HarvestSpec> autoHarvests;
+    QHash<QString, ActiveHarvest> activeHarvests;
+    QHash<QObject *, QString> inFlightDetails;
+
+    QList<HarvestTask> taskQueue;
+    QHash<QObject *, HarvestTask> inFlightTasks;
+};
+
+#endif // AGAVEJOBHARVESTER_H
@@ -0,0 +1,177 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavejobquery.h"
+
+AgaveJobQuery::AgaveJobQuery()
+{
+    //Note: defaults are handled in the class header
+}
+
+void AgaveJobQuery::setStatusList(QStringList newStatusList)
+{
+    statusList = newStatusList;
+}
+
+void AgaveJobQuery::setJobIDList(QStringList newJobIDList)
+{
+    jobIDList = newJobIDList;
+}
+
+void AgaveJobQuery::setAppID(QString newAppID)
+{
+    appID = newAppID;
+}
+
+void AgaveJobQuery::setCreatedAfter(QDateTime newTime)
+{
+    createdAfter = newTime;
+}
+
+void AgaveJobQuery::setLimit(int newLimit)
+{
+    limit = newLimit;
+}
+
+void AgaveJobQuery::setOffset(int newOffset)
+{
+    offset = newOffset;
+}
+
+void AgaveJobQuery::setFieldList(QStringList newFieldList)
+{
+    fieldList = newFieldList;
+}
+
+QStringList AgaveJobQuery::getStatusList() const
+{
+    return statusList;
+}
+
+QStringList AgaveJobQuery::getJobIDList() const
+{
+    return jobIDList;
+}
+
+QString AgaveJobQuery::getAppID() const
+{
+    return appID;
+}
+
+QDateTime AgaveJobQuery::getCreatedAfter() const
+{
+    return createdAfter;
+}
+
+int AgaveJobQuery::getLimit() const
+{
+    return limit;
+}
+
+int AgaveJobQuery::getOffset() const
+{
+    return offset;
+}
+
+QStringList AgaveJobQuery::getFieldList() const
+{
+    return fieldList;
+}
+
+QString AgaveJobQuery::getURLQueryString() const
+{
+    QUrlQuery ret;
+
+    if (statusList.size() == 1)
+    {
+        ret.addQueryItem("status.eq", statusList.at(0));
+    }
+    else if (statusList.size() > 1)
+    {
+        ret.addQueryItem("status.in", statusList.join(','));
+    }
+
+    if (jobIDList.size() == 1)
+    {
+        ret.addQueryItem("id.eq", jobIDList.at(0));
+    }
+    else if (jobIDList.size() > 1)
+    {
+        ret.addQueryItem("id.in", jobIDList.join(','));
+    }
+
+    if (!appID.isEmpty())
+    {
+        ret.addQueryItem("appId.eq", appID);
+    }
+
+    if (createdAfter.isValid())
+    {
+        ret.addQueryItem("created.after", createdAfter.toUTC().toString(Qt::ISODate));
+    }
+
+    if (limit >= 0)
+    {
+        ret.addQueryItem("limit", QString::number(limit));
+    }
+
+    if (offset > 0)
+    {
+        ret.addQueryItem("offset", QString::number(offset));
+    }
+
+    if (!fieldList.isEmpty())
+    {
+        //The job list parser rejects entries without these, so they are always requested
+        QStringList allFields = {"id", "name", "appId", "created", "status"};
+        for (auto itr = fieldList.cbegin(); itr != fieldList.cend(); itr++)
+        {
+            if (!allFields.contains(*itr))
+            {
+                allFields.append(*itr);
+            }
+        }
+        ret.addQueryItem("filter", allFields.join(','));
+    }
+
+    if (ret.isEmpty())
+    {
+        return QString();
+    }
+
+    QString queryString = "?";
+    queryString.append(ret.toString(QUrl::FullyEncoded));
+    return queryString;
+}
@@ -0,0 +1,81 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEJOBQUERY_H
+#define AGAVEJOBQUERY_H
+
+#include <QString>
+#include <QStringList>
+#include <QDateTime>
+#include <QUrlQuery>
+
+//Describes a filtered request for the Agave job list
+//Unset values are not sent, so an empty query lists all jobs, as getListOfJobs() does
+class AgaveJobQuery
+{
+public:
+    AgaveJobQuery();
+
+    void setStatusList(QStringList newStatusList);
+    void setJobIDList(QStringList newJobIDList);
+    void setAppID(QString newAppID);
+    void setCreatedAfter(QDateTime newTime);
+    void setLimit(int newLimit);
+    void setOffset(int newOffset);
+    void setFieldList(QStringList newFieldList);
+
+    QStringList getStatusList() const;
+    QStringList getJobIDList() const;
+    QString getAppID() const;
+    QDateTime getCreatedAfter() const;
+    int getLimit() const;
+    int getOffset() const;
+    QStringList getFieldList() const;
+
+    //Gives the query string to append to the job list URL, including the leading '?'
+    //Empty if no filter is set
+    QString getURLQueryString() const;
+
+private:
+    QStringList statusList;
+    QStringList jobIDList;
+    QString appID;
+    QDateTime createdAfter;
+    int limit = -1; //Negative means server default
+    int offset = 0;
+    QStringList fieldList;
+};
+
+#endif // AGAVEJOBQUERY_H
@@ -0,0 +1,381 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavejobwatcher.h"
+#include "agavehandler.h"
+#include "agavejobquery.h"
+#include "agavelogging.h"
+
+#include "../remotejobdata.h"
+
+AgaveJobWatcher::AgaveJobWatcher(AgaveHandler * theManager) : QObject((QObject *)theManager)
+{
+    myManager = theManager;
+    watchClock.start();
+
+    pollTimer.setSingleShot(true);
+    QObject::connect(&pollTimer, SIGNAL(timeout()), this, SLOT(pollDueJobs()));
+}
+
+void AgaveJobWatcher::watchJob(QString jobID, QString knownState)
+{
+    if (jobID.isEmpty() || isTerminalState(knownState)) return;
+
+    WatchedJob newJob;
+    newJob.state = knownState;
+    newJob.pollInterval = minInterval;
+    newJob.nextPoll = watchClock.elapsed();
+    newJob.pollPending = false;
+    newJob.pushMode = false;
+    newJob.pushTimeout = 0;
+
+    auto itr = watchedJobs.find(jobID);
+    if (itr != watchedJobs.end())
+    {
+        //Already watched: only check on it soon
+        itr->pollInterval = minInterval;
+        if (!itr->pollPending) itr->nextPoll = newJob.nextPoll;
+    }
+    else
+    {
+        watchedJobs.insert(jobID, newJob);
+    }
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::watchPushedJob(QString jobID, QString knownState, int pushTimeoutMsecs)
+{
+    if (jobID.isEmpty() || isTerminalState(knownState)) return;
+
+    WatchedJob newJob;
+    newJob.state = knownState;
+    newJob.pollInterval = minInterval;
+    newJob.nextPoll = watchClock.elapsed() + pushTimeoutMsecs;
+    newJob.pollPending = false;
+    newJob.pushMode = true;
+    newJob.pushTimeout = pushTimeoutMsecs;
+
+    watchedJobs.insert(jobID, newJob);
+
+    //An event may have come in before the submit reply
+    QString earlyState = earlyPushedStates.take(jobID);
+    if (!earlyState.isEmpty())
+    {
+        applyJobState(jobID, earlyState);
+    }
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::applyPushedState(QString jobID, QString newState)
+{
+    auto itr = watchedJobs.find(jobID);
+    if (itr == watchedJobs.end())
+    {
+        //Kept for watchPushedJob, for a job whose submit reply has not come in yet
+        if (earlyPushedStates.size() >= maxEarlyStates)
+        {
+            earlyPushedStates.clear();
+        }
+        earlyPushedStates.insert(jobID, newState);
+        return;
+    }
+
+    //Events arrive, so polling can go back to being a rare check
+    itr->pushMode = true;
+    if (itr->pushTimeout <= 0) itr->pushTimeout = maxInterval;
+    applyJobState(jobID, newState);
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::unwatchJob(QString jobID)
+{
+    watchedJobs.remove(jobID);
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::unwatchAll()
+{
+    watchedJobs.clear();
+    earlyPushedStates.clear();
+    pollTimer.stop();
+}
+
+bool AgaveJobWatcher::isWatching(QString jobID)
+{
+    return watchedJobs.contains(jobID);
+}
+
+QStringList AgaveJobWatcher::getWatchedJobs()
+{
+    return watchedJobs.keys();
+}
+
+QString AgaveJobWatcher::getLastKnownState(QString jobID)
+{
+    return watchedJobs.value(jobID).state;
+}
+
+void AgaveJobWatcher::setPollIntervals(int minMsecs, int maxMsecs, int transientMsecs)
+{
+    minInterval = qMax(minMsecs, 1000);
+    maxInterval = qMax(maxMsecs, minInterval);
+    transientInterval = qBound(minInterval, transientMsecs, maxInterval);
+}
+
+void AgaveJobWatcher::setBackoffFactor(double newFactor)
+{
+    backoffFactor = qMax(newFactor, 1.0);
+}
+
+void AgaveJobWatcher::setBatchLimit(int maxJobsPerRequest)
+{
+    batchLimit = qMax(maxJobsPerRequest, 1);
+}
+
+bool AgaveJobWatcher::isTerminalState(QString jobState)
+{
+    return ((jobState == "FINISHED") || (jobState == "FAILED") || (jobState == "STOPPED")
+            || (jobState == "KILLED") || (jobState == "ARCHIVING_FAILED"));
+}
+
+bool AgaveJobWatcher::isTransientState(QString jobState)
+{
+    return ((jobState == "PENDING") || (jobState == "PROCESSING_INPUTS") || (jobState == "STAGING_INPUTS")
+            || (jobState == "STAGED") || (jobState == "STAGING_JOB") || (jobState == "SUBMITTING")
+            || (jobState == "CLEANING_UP") || (jobState == "ARCHIVING") || (jobState == "ARCHIVING_FINISHED"));
+}
+
+void AgaveJobWatcher::pollDueJobs()
+{
+    qint64 now = watchClock.elapsed();
+    QStringList dueJobs;
+    for (auto itr = watchedJobs.begin(); itr != watchedJobs.end(); itr++)
+    {
+        if (!itr->pollPending && (itr->nextPoll <= now))
+        {
+            //A push job only comes due if its events stopped
+            itr->pushMode = false;
+            dueJobs.append(itr.key());
+        }
+    }
+
+    if ((dueJobs.size() == 1) || !batchListingWorks)
+    {
+        for (const QString &jobID : dueJobs)
+        {
+            pollJobDetails(jobID);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < dueJobs.size(); i += batchLimit)
+        {
+            pollJobList(dueJobs.mid(i, batchLimit));
+        }
+    }
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::gotJobList(RequestState replyState, QList<RemoteJobData> jobList)
+{
+    RemoteDataReply * theReply = qobject_cast<RemoteDataReply *>(QObject::sender());
+    if (theReply == NULL) return;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    QStringList requestedIDs = theReply->getTaskParamList()->value("watchedIDs").split(',', Qt::SkipEmptyParts);
+#else
+    QStringList requestedIDs = theReply->getTaskParamList()->value("watchedIDs").split(',', QString::SkipEmptyParts);
+#endif
+
+    if (replyState != RequestState::GOOD)
+    {
+        if (replyState == RequestState::FAIL)
+        {
+            qCDebug(agaveReplies, "Filtered job list refused, job watcher will poll jobs one at a time");
+            batchListingWorks = false;
+        }
+        for (const QString &jobID : requestedIDs)
+        {
+            pollFailed(jobID);
+        }
+        scheduleNextPoll();
+        return;
+    }
+
+    for (auto itr = jobList.constBegin(); itr != jobList.constEnd(); itr++)
+    {
+        if (requestedIDs.removeOne((*itr).getID()))
+        {
+            applyJobState((*itr).getID(), (*itr).getState());
+        }
+    }
+
+    //Jobs missing from the list are asked for one by one
+    for (const QString &jobID : requestedIDs)
+    {
+        auto jobItr = watchedJobs.find(jobID);
+        if (jobItr == watchedJobs.end()) continue;
+        jobItr->pollPending = false;
+        pollJobDetails(jobID);
+    }
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::gotJobDetails(RequestState replyState, RemoteJobData jobData)
+{
+    RemoteDataReply * theReply = qobject_cast<RemoteDataReply *>(QObject::sender());
+    if (theReply == NULL) return;
+    QString jobID = theReply->getTaskParamList()->value("IDstr");
+
+    if (replyState != RequestState::GOOD)
+    {
+        pollFailed(jobID);
+    }
+    else
+    {
+        applyJobState(jobID, jobData.getState());
+    }
+    scheduleNextPoll();
+}
+
+void AgaveJobWatcher::pollJobList(QStringList jobIDs)
+{
+    AgaveJobQuery watchQuery;
+    watchQuery.setJobIDList(jobIDs);
+    watchQuery.setLimit(jobIDs.size());
+
+    RemoteDataReply * theReply = myManager->getListOfJobs(watchQuery);
+    if (theReply == NULL)
+    {
+        for (const QString &jobID : jobIDs)
+        {
+            pollFailed(jobID);
+        }
+        return;
+    }
+
+    theReply->getTaskParamList()->insert("watchedIDs", jobIDs.join(','));
+    for (const QString &jobID : jobIDs)
+    {
+        watchedJobs[jobID].pollPending = true;
+    }
+    QObject::connect(theReply, SIGNAL(haveJobListResult(RequestState,QList<RemoteJobData>)),
+                     this, SLOT(gotJobList(RequestState,QList<RemoteJobData>)));
+}
+
+void AgaveJobWatcher::pollJobDetails(QString jobID)
+{
+    RemoteDataReply * theReply = myManager->getJobDetails(jobID);
+    if (theReply == NULL)
+    {
+        pollFailed(jobID);
+        return;
+    }
+
+    watchedJobs[jobID].pollPending = true;
+    QObject::connect(theReply, SIGNAL(haveJobDetailsResult(RequestState,RemoteJobData)),
+                     this, SLOT(gotJobDetails(RequestState,RemoteJobData)));
+}
+
+void AgaveJobWatcher::applyJobState(QString jobID, QString newState)
+{
+    auto itr = watchedJobs.find(jobID);
+    if (itr == watchedJobs.end()) return;
+
+    itr->pollPending = false;
+    QString oldState = itr->state;
+
+    if (oldState == newState)
+    {
+        itr->pollInterval = qMin((int)(itr->pollInterval * backoffFactor), maxInterval);
+    }
+    else
+    {
+        itr->state = newState;
+        itr->pollInterval = minInterval;
+    }
+    if (isTransientState(newState))
+    {
+        itr->pollInterval = qMin(itr->pollInterval, transientInterval);
+    }
+    itr->nextPoll = watchClock.elapsed() + itr->pollInterval;
+    if (itr->pushMode)
+    {
+        itr->nextPoll = watchClock.elapsed() + qMax(itr->pushTimeout, maxInterval);
+    }
+
+    if (isTerminalState(newState))
+    {
+        watchedJobs.erase(itr);
+    }
+
+    if (oldState != newState)
+    {
+        emit jobStateChanged(jobID, oldState, newState);
+    }
+    if (isTerminalState(newState))
+    {
+        emit jobWatchEnded(jobID, newState);
+    }
+}
+
+void AgaveJobWatcher::pollFailed(QString jobID)
+{
+    auto itr = watchedJobs.find(jobID);
+    if (itr == watchedJobs.end()) return;
+
+    //Try again later, without counting it as time spent in the same state
+    itr->pollPending = false;
+    itr->nextPoll = watchClock.elapsed() + itr->pollInterval;
+}
+
+void AgaveJobWatcher::scheduleNextPoll()
+{
+    qint64 nextPoll = -1;
+    for (auto itr = watchedJobs.constBegin(); itr != watchedJobs.constEnd(); itr++)
+    {
+        if (itr->pollPending) continue;
+        if ((nextPoll < 0) || (itr->nextPoll < nextPoll))
+        {
+            nextPoll = itr->nextPoll;
+        }
+    }
+
+    if (nextPoll < 0)
+    {
+        pollTimer.stop();
+        return;
+    }
+    pollTimer.start((int) qMax(nextPoll - watchClock.elapsed(), (qint64) 0));
+}
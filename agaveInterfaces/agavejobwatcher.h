@@ -0,0 +1,130 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEJOBWATCHER_H
+#define AGAVEJOBWATCHER_H
+
+#include "../remotedatainterface.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+class AgaveHandler;
+class RemoteJobData;
+
+//Keeps track of the state of a set of jobs, and only signals when one changes
+//Due jobs are polled together with one job list request filtered by ID,
+//with single job detail requests as a fallback.
+//Each job is polled less often the longer it stays in one state, up to the max interval.
+//Short-lived states (staging, submitting, archiving, ...) are never polled slower than the transient interval.
+//A job is no longer watched once it reaches a terminal state.
+class AgaveJobWatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveJobWatcher(AgaveHandler * theManager);
+
+    //knownState avoids a state change signal for a state the caller already has
+    void watchJob(QString jobID, QString knownState = "");
+    //For jobs which send notifications: the job is only polled if no event arrives within pushTimeout,
+    //and after that as a rare check. Without events, it falls back to normal polling.
+    void watchPushedJob(QString jobID, QString knownState, int pushTimeoutMsecs = 60000);
+    void unwatchJob(QString jobID);
+    void unwatchAll();
+
+    bool isWatching(QString jobID);
+    QStringList getWatchedJobs();
+    QString getLastKnownState(QString jobID);
+
+    void setPollIntervals(int minMsecs, int maxMsecs, int transientMsecs);
+    void setBackoffFactor(double newFactor);
+    void setBatchLimit(int maxJobsPerRequest);
+
+    static bool isTerminalState(QString jobState);
+    static bool isTransientState(QString jobState);
+
+public slots:
+    void applyPushedState(QString jobID, QString newState);
+
+signals:
+    void jobStateChanged(QString jobID, QString oldState, QString newState);
+    void jobWatchEnded(QString jobID, QString finalState);
+
+private slots:
+    void pollDueJobs();
+    void gotJobList(RequestState replyState, QList<RemoteJobData> jobList);
+    void gotJobDetails(RequestState replyState, RemoteJobData jobData);
+
+private:
+    struct WatchedJob
+    {
+        QString state;
+        int pollInterval;
+        qint64 nextPoll;
+        bool pollPending;
+        bool pushMode;
+        int pushTimeout;
+    };
+
+    void pollJobList(QStringList jobIDs);
+    void pollJobDetails(QString jobID);
+    void applyJobState(QString jobID, QString newState);
+    void pollFailed(QString jobID);
+    void scheduleNextPoll();
+
+    AgaveHandler * myManager = NULL;
+
+    QHash<QString, WatchedJob> watchedJobs;
+    //Pushed states of jobs not yet watched, at most maxEarlyStates of them
+    QHash<QString, QString> earlyPushedStates;
+    static const int maxEarlyStates = 64;
+    QTimer pollTimer;
+    QElapsedTimer watchClock;
+
+    int minInterval = 5000;
+    int maxInterval = 300000;
+    int transientInterval = 15000;
+    double backoffFactor = 1.5;
+    int batchLimit = 100;
+
+    //Cleared if the server refuses the filtered job list
+    bool batchListingWorks = true;
+};
+
+#endif // AGAVEJOBWATCHER_H
@@ -0,0 +1,229 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavelistingcache.h"
+
+AgaveListingCache::AgaveListingCache()
+{
+    cacheClock.start();
+}
+
+void AgaveListingCache::setTimeToLive(int msecs)
+{
+    timeToLive = msecs;
+    if (timeToLive <= 0)
+    {
+        clear();
+    }
+}
+
+int AgaveListingCache::getTimeToLive()
+{
+    return timeToLive;
+}
+
+void AgaveListingCache::setMaxEntries(int newMax)
+{
+    maxEntries = newMax;
+    while ((maxEntries > 0) && (cacheEntries.size() > maxEntries))
+    {
+        evictOldest();
+    }
+}
+
+bool AgaveListingCache::isEnabled()
+{
+    return (timeToLive > 0);
+}
+
+bool AgaveListingCache::lookupListing(QString dirPath, FileListing * foundListing)
+{
+    if (!isEnabled()) return false;
+
+    if (peekListing(dirPath, foundListing))
+    {
+        hitCount++;
+        return true;
+    }
+    missCount++;
+    return false;
+}
+
+bool AgaveListingCache::peekListing(QString dirPath, FileListing * foundListing)
+{
+    if (!isEnabled()) return false;
+
+    auto itr = cacheEntries.find(getCacheKey(dirPath));
+    if (itr == cacheEntries.end()) return false;
+
+    if (!isFresh(*itr))
+    {
+        cacheEntries.erase(itr);
+        return false;
+    }
+
+    *foundListing = itr->listing;
+    return true;
+}
+
+void AgaveListingCache::storeListing(QString dirPath, FileListing newListing)
+{
+    if (!isEnabled()) return;
+
+    QString theKey = getCacheKey(dirPath);
+    if ((maxEntries > 0) && (!cacheEntries.contains(theKey)) && (cacheEntries.size() >= maxEntries))
+    {
+        evictOldest();
+    }
+
+    CacheEntry newEntry;
+    newEntry.listing = newListing;
+    newEntry.storedAt = cacheClock.elapsed();
+    cacheEntries.insert(theKey, newEntry);
+}
+
+bool AgaveListingCache::insertFile(const FileMetaData &newFile)
+{
+    auto itr = cacheEntries.find(getCacheKey(newFile.getContainingPath()));
+    if ((itr == cacheEntries.end()) || !isFresh(*itr)) return false;
+
+    //Patching does not renew the entry, the time to live still counts from the last real listing
+    itr->listing = itr->listing.withFile(newFile);
+    patchCount++;
+    return true;
+}
+
+bool AgaveListingCache::removeFile(QString fullPath)
+{
+    QString fileName = FileMetaData::canonicalizePath("", fullPath).section('/', -1);
+    auto itr = cacheEntries.find(getParentKey(fullPath));
+    if ((itr == cacheEntries.end()) || !isFresh(*itr)) return false;
+
+    itr->listing = itr->listing.withoutFile(fileName);
+    patchCount++;
+    return true;
+}
+
+void AgaveListingCache::invalidateTree(QString dirPath)
+{
+    QString theKey = getCacheKey(dirPath);
+    QString subKey = theKey;
+    subKey.append('/');
+
+    for (auto itr = cacheEntries.begin(); itr != cacheEntries.end(); )
+    {
+        if ((itr.key() == theKey) || itr.key().startsWith(subKey))
+        {
+            itr = cacheEntries.erase(itr);
+            invalidationCount++;
+        }
+        else
+        {
+            itr++;
+        }
+    }
+}
+
+void AgaveListingCache::clear()
+{
+    cacheEntries.clear();
+}
+
+int AgaveListingCache::getHitCount()
+{
+    return hitCount;
+}
+
+int AgaveListingCache::getMissCount()
+{
+    return missCount;
+}
+
+int AgaveListingCache::getPatchCount()
+{
+    return patchCount;
+}
+
+int AgaveListingCache::getInvalidationCount()
+{
+    return invalidationCount;
+}
+
+double AgaveListingCache::getHitRate()
+{
+    int totalLookups = hitCount + missCount;
+    if (totalLookups == 0) return 0.0;
+    return (double) hitCount / (double) totalLookups;
+}
+
+void AgaveListingCache::resetCounts()
+{
+    hitCount = 0;
+    missCount = 0;
+    patchCount = 0;
+    invalidationCount = 0;
+}
+
+QString AgaveListingCache::getCacheKey(QString dirPath)
+{
+    return FileMetaData::canonicalizePath("", dirPath);
+}
+
+QString AgaveListingCache::getParentKey(QString fullPath)
+{
+    QString canonPath = FileMetaData::canonicalizePath("", fullPath);
+    return canonPath.left(canonPath.lastIndexOf('/'));
+}
+
+bool AgaveListingCache::isFresh(const CacheEntry &anEntry)
+{
+    return ((cacheClock.elapsed() - anEntry.storedAt) < timeToLive);
+}
+
+void AgaveListingCache::evictOldest()
+{
+    auto oldest = cacheEntries.end();
+    for (auto itr = cacheEntries.begin(); itr != cacheEntries.end(); itr++)
+    {
+        if ((oldest == cacheEntries.end()) || (itr->storedAt < oldest->storedAt))
+        {
+            oldest = itr;
+        }
+    }
+    if (oldest != cacheEntries.end())
+    {
+        cacheEntries.erase(oldest);
+    }
+}
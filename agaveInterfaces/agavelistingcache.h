@@ -0,0 +1,104 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVELISTINGCACHE_H
+#define AGAVELISTINGCACHE_H
+
+#include "../filelisting.h"
+
+#include <QString>
+#include <QHash>
+#include <QElapsedTimer>
+
+//Recent directory listings, keyed by canonical path ("/a/b")
+//Entries older than the time to live are treated as missing.
+//File operation results patch the listing of the folder they are in, when it is cached.
+class AgaveListingCache
+{
+public:
+    AgaveListingCache();
+
+    void setTimeToLive(int msecs); //0 disables the cache
+    int getTimeToLive();
+    void setMaxEntries(int newMax);
+    bool isEnabled();
+
+    //Counts a hit or a miss
+    bool lookupListing(QString dirPath, FileListing * foundListing);
+    //As lookupListing, but does not count toward the hit rate
+    bool peekListing(QString dirPath, FileListing * foundListing);
+    void storeListing(QString dirPath, FileListing newListing);
+
+    //Returns true if the containing folder's listing was cached and has been updated
+    bool insertFile(const FileMetaData &newFile);
+    bool removeFile(QString fullPath);
+
+    //Drops the listing of this path and of every folder under it
+    void invalidateTree(QString dirPath);
+    void clear();
+
+    int getHitCount();
+    int getMissCount();
+    int getPatchCount();
+    int getInvalidationCount();
+    double getHitRate();
+    void resetCounts();
+
+    static QString getCacheKey(QString dirPath);
+    static QString getParentKey(QString fullPath);
+
+private:
+    struct CacheEntry
+    {
+        FileListing listing;
+        qint64 storedAt;
+    };
+
+    bool isFresh(const CacheEntry &anEntry);
+    void evictOldest();
+
+    QHash<QString, CacheEntry> cacheEntries;
+    QElapsedTimer cacheClock;
+
+    int timeToLive = 0;
+    int maxEntries = 256;
+
+    int hitCount = 0;
+    int missCount = 0;
+    int patchCount = 0;
+    int invalidationCount = 0;
+};
+
+#endif // AGAVELISTINGCACHE_H
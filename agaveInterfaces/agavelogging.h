@@ -0,0 +1,70 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVELOGGING_H
+#define AGAVELOGGING_H
+
+#include <QLoggingCategory>
+#include <QByteArray>
+
+//Logging categories for the Agave interface. Debug output is off by default,
+//enable it with QT_LOGGING_RULES, ie. "agave.requests.debug=true"
+//agave.payload dumps request and reply bodies, capped at getPayloadLogLimit() bytes
+//Building with AGAVE_NO_PAYLOAD_LOGGING removes payload dumps entirely
+Q_DECLARE_LOGGING_CATEGORY(agaveRequests)
+Q_DECLARE_LOGGING_CATEGORY(agaveReplies)
+Q_DECLARE_LOGGING_CATEGORY(agaveAuth)
+Q_DECLARE_LOGGING_CATEGORY(agavePayload)
+
+class AgaveLogging
+{
+public:
+    static void setPayloadLogLimit(int numBytes);
+    static int getPayloadLogLimit();
+
+    static QByteArray cappedPayload(const QByteArray &payload);
+
+private:
+    static int payloadLogLimit;
+};
+
+//Arguments are only evaluated if agave.payload debug output is enabled
+#ifdef AGAVE_NO_PAYLOAD_LOGGING
+#define AGAVE_LOG_PAYLOAD(label, payload) do {} while (false)
+#else
+#define AGAVE_LOG_PAYLOAD(label, payload) qCDebug(agavePayload, "%s: %s", label, AgaveLogging::cappedPayload(payload).constData())
+#endif
+
+#endif // AGAVELOGGING_H
@@ -0,0 +1,561 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavemetadatastore.h"
+#include "agavelistingcache.h"
+#include "agavelogging.h"
+
+static const char storeMagic[8] = {'A','G','V','S','T','O','R','E'};
+static const quint32 storeVersion = 3;
+static const qint64 storeHeaderSize = 12;
+static const qint64 recordPrefixSize = 12;
+
+//A job takes at least this much for its strings, time and maps, so a larger count is corrupt
+static const qint64 minJobBytes = 40;
+
+//Below this size, a store is not worth compacting
+static const qint64 minCompactSize = 65536;
+
+AgaveMetadataStore::AgaveMetadataStore()
+{
+
+}
+
+AgaveMetadataStore::~AgaveMetadataStore()
+{
+    closeStore();
+}
+
+bool AgaveMetadataStore::openStore(QString storeDir, QString accountName, QString storageSystem)
+{
+    closeStore();
+
+    QDir theDir(storeDir);
+    if (!theDir.exists() && !theDir.mkpath("."))
+    {
+        qCWarning(agaveRequests, "Unable to create metadata store folder: %s", qPrintable(storeDir));
+        return false;
+    }
+
+    QString fileName = QString("%1@%2.agvstore").arg(sanitizeFileNamePart(accountName), sanitizeFileNamePart(storageSystem));
+    storeFile.setFileName(theDir.filePath(fileName));
+
+    //Another session appending to, truncating or compacting the same file would corrupt it
+    storeLock.reset(new QLockFile(storeFile.fileName() + ".lock"));
+    //A lock left by a session which has exited is taken over, one held by a running session never is
+    storeLock->setStaleLockTime(std::numeric_limits<int>::max());
+    if (!storeLock->tryLock(0))
+    {
+        qCWarning(agaveRequests, "Metadata store in use by another session, not using it: %s", qPrintable(storeFile.fileName()));
+        storeLock.reset();
+        return false;
+    }
+
+    if (!storeFile.open(QIODevice::ReadWrite))
+    {
+        qCWarning(agaveRequests, "Unable to open metadata store: %s", qPrintable(storeFile.fileName()));
+        storeLock.reset();
+        return false;
+    }
+
+    if (!readIndex())
+    {
+        //Unreadable or from another version: start over
+        recordIndex.clear();
+        liveBytes = 0;
+        unmapStoreFile();
+        if (!storeFile.resize(0) || !writeHeader())
+        {
+            storeFile.close();
+            storeLock.reset();
+            return false;
+        }
+    }
+
+    if (needsCompaction())
+    {
+        compactStore();
+    }
+
+    qCDebug(agaveRequests, "Metadata store opened with %d records", recordIndex.size());
+    if (!storeFile.isOpen())
+    {
+        storeLock.reset();
+        return false;
+    }
+    return true;
+}
+
+void AgaveMetadataStore::closeStore()
+{
+    if (storeFile.isOpen())
+    {
+        if (needsCompaction())
+        {
+            compactStore();
+        }
+        unmapStoreFile();
+        storeFile.close();
+    }
+    recordIndex.clear();
+    liveBytes = 0;
+    //Unlocks the store for other sessions
+    storeLock.reset();
+}
+
+bool AgaveMetadataStore::isOpen()
+{
+    return storeFile.isOpen();
+}
+
+QString AgaveMetadataStore::getStoreFileName()
+{
+    return storeFile.fileName();
+}
+
+bool AgaveMetadataStore::loadListing(QString dirPath, FileListing * foundListing)
+{
+    if (!isOpen()) return false;
+
+    QString theKey = getListingKey(dirPath);
+    QByteArray payload;
+    if (!readRecord(theKey, &payload)) return false;
+
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    FileListing readListing;
+    payloadStream >> readListing;
+    if (payloadStream.status() != QDataStream::Ok)
+    {
+        dropRecord(theKey);
+        return false;
+    }
+
+    *foundListing = readListing;
+    return true;
+}
+
+void AgaveMetadataStore::saveListing(QString dirPath, FileListing newListing)
+{
+    if (!isOpen()) return;
+
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    payloadStream << newListing;
+
+    appendRecord(getListingKey(dirPath), payload);
+}
+
+void AgaveMetadataStore::removeListing(QString dirPath)
+{
+    if (!isOpen()) return;
+
+    QString theKey = getListingKey(dirPath);
+    if (!recordIndex.contains(theKey)) return;
+    appendRecord(theKey, QByteArray());
+}
+
+void AgaveMetadataStore::removeTree(QString dirPath)
+{
+    if (!isOpen()) return;
+
+    QString theKey = getListingKey(dirPath);
+    QString subKey = theKey;
+    subKey.append('/');
+
+    QStringList toRemove;
+    for (auto itr = recordIndex.constBegin(); itr != recordIndex.constEnd(); itr++)
+    {
+        if ((itr.key() == theKey) || itr.key().startsWith(subKey))
+        {
+            toRemove.append(itr.key());
+        }
+    }
+    for (const QString &aKey : toRemove)
+    {
+        appendRecord(aKey, QByteArray());
+    }
+}
+
+bool AgaveMetadataStore::loadJobList(QList<RemoteJobData> * foundList)
+{
+    if (!isOpen()) return false;
+
+    QByteArray payload;
+    if (!readRecord("J:", &payload)) return false;
+
+    //Read as QList's stream operator would, but without trusting the count
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    quint32 numJobs;
+    payloadStream >> numJobs;
+    if ((payloadStream.status() != QDataStream::Ok) || (numJobs > payload.size() / minJobBytes))
+    {
+        dropRecord("J:");
+        return false;
+    }
+    QList<RemoteJobData> readList;
+    readList.reserve(numJobs);
+    for (quint32 i = 0; (i < numJobs) && (payloadStream.status() == QDataStream::Ok); i++)
+    {
+        RemoteJobData aJob;
+        payloadStream >> aJob;
+        readList.append(aJob);
+    }
+    if (payloadStream.status() != QDataStream::Ok)
+    {
+        dropRecord("J:");
+        return false;
+    }
+
+    *foundList = readList;
+    return true;
+}
+
+void AgaveMetadataStore::saveJobList(QList<RemoteJobData> newList)
+{
+    if (!isOpen()) return;
+
+    QByteArray payload;
+    QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+    payloadStream.setVersion(QDataStream::Qt_5_6);
+    payloadStream << newList;
+
+    appendRecord("J:", payload);
+}
+
+int AgaveMetadataStore::getRecordCount()
+{
+    return recordIndex.size();
+}
+
+bool AgaveMetadataStore::compactStore()
+{
+    if (!isOpen()) return false;
+
+    //Written beside the store, then renamed over it in one step, so the store is never missing or partly written
+    QString storeName = storeFile.fileName();
+    QSaveFile compactFile(storeName);
+    if (!compactFile.open(QIODevice::WriteOnly))
+    {
+        return false;
+    }
+
+    //The live records are copied as they are, so nothing needs to be decoded
+    QByteArray header(storeMagic, sizeof(storeMagic));
+    quint32 versionLE = qToLittleEndian(storeVersion);
+    header.append((const char *) &versionLE, sizeof(versionLE));
+    compactFile.write(header);
+
+    if (!mapStoreFile())
+    {
+        compactFile.cancelWriting();
+        return false;
+    }
+
+    QHash<QString, RecordRef> newIndex;
+    qint64 writePos = storeHeaderSize;
+    for (auto itr = recordIndex.constBegin(); itr != recordIndex.constEnd(); itr++)
+    {
+        qint64 recordStart = itr->payloadOffset + itr->payloadLength - itr->recordLength - recordPrefixSize;
+        qint64 recordSize = itr->recordLength + recordPrefixSize;
+        if (compactFile.write((const char *) mappedData + recordStart, recordSize) != recordSize)
+        {
+            compactFile.cancelWriting();
+            return false;
+        }
+
+        RecordRef newRef = *itr;
+        newRef.payloadOffset = writePos + recordSize - itr->payloadLength;
+        newIndex.insert(itr.key(), newRef);
+        writePos += recordSize;
+    }
+
+    //Some systems cannot replace a file which is open
+    unmapStoreFile();
+    storeFile.close();
+    bool replaced = compactFile.commit();
+    if (!replaced)
+    {
+        qCWarning(agaveRequests, "Unable to replace metadata store during compaction");
+    }
+
+    //On failure, the old file is still there and the old index still fits it
+    storeFile.setFileName(storeName);
+    if (!storeFile.open(QIODevice::ReadWrite))
+    {
+        recordIndex.clear();
+        liveBytes = 0;
+        return false;
+    }
+    if (!replaced) return false;
+
+    recordIndex = newIndex;
+    liveBytes = writePos - storeHeaderSize;
+    return true;
+}
+
+bool AgaveMetadataStore::mapStoreFile()
+{
+    qint64 fileSize = storeFile.size();
+    if ((mappedData != NULL) && (mappedSize == fileSize)) return true;
+
+    unmapStoreFile();
+    if (fileSize <= 0) return false;
+
+    mappedData = storeFile.map(0, fileSize);
+    if (mappedData == NULL) return false;
+    mappedSize = fileSize;
+    return true;
+}
+
+void AgaveMetadataStore::unmapStoreFile()
+{
+    if (mappedData != NULL)
+    {
+        storeFile.unmap(mappedData);
+    }
+    mappedData = NULL;
+    mappedSize = 0;
+}
+
+bool AgaveMetadataStore::readIndex()
+{
+    recordIndex.clear();
+    liveBytes = 0;
+
+    if (storeFile.size() == 0)
+    {
+        return writeHeader();
+    }
+    if (storeFile.size() < storeHeaderSize) return false;
+    if (!mapStoreFile()) return false;
+
+    if (memcmp(mappedData, storeMagic, sizeof(storeMagic)) != 0) return false;
+    if (qFromLittleEndian<quint32>(mappedData + sizeof(storeMagic)) != storeVersion) return false;
+
+    qint64 readPos = storeHeaderSize;
+    while (readPos + recordPrefixSize <= mappedSize)
+    {
+        quint32 recordLength = qFromLittleEndian<quint32>(mappedData + readPos);
+        quint32 keyLength = qFromLittleEndian<quint32>(mappedData + readPos + 4);
+        if ((keyLength > recordLength) || (readPos + recordPrefixSize + recordLength > mappedSize))
+        {
+            break;
+        }
+
+        QString theKey = QString::fromUtf8((const char *) mappedData + readPos + recordPrefixSize, keyLength);
+        auto oldRecord = recordIndex.constFind(theKey);
+        if (oldRecord != recordIndex.constEnd())
+        {
+            liveBytes -= oldRecord->recordLength + recordPrefixSize;
+            recordIndex.erase(oldRecord);
+        }
+
+        RecordRef newRef;
+        newRef.recordLength = recordLength;
+        newRef.payloadLength = recordLength - keyLength;
+        newRef.payloadOffset = readPos + recordPrefixSize + keyLength;
+        newRef.checksum = qFromLittleEndian<quint32>(mappedData + readPos + 8);
+        if (newRef.payloadLength > 0)
+        {
+            recordIndex.insert(theKey, newRef);
+            liveBytes += recordLength + recordPrefixSize;
+        }
+
+        readPos += recordPrefixSize + recordLength;
+    }
+
+    if (readPos < mappedSize)
+    {
+        qCWarning(agaveRequests, "Dropping truncated record at end of metadata store");
+        unmapStoreFile();
+        if (!storeFile.resize(readPos)) return false;
+    }
+    return true;
+}
+
+bool AgaveMetadataStore::writeHeader()
+{
+    QByteArray header(storeMagic, sizeof(storeMagic));
+    quint32 versionLE = qToLittleEndian(storeVersion);
+    header.append((const char *) &versionLE, sizeof(versionLE));
+
+    storeFile.seek(0);
+    return (storeFile.write(header) == storeHeaderSize);
+}
+
+bool AgaveMetadataStore::appendRecord(const QString &key, const QByteArray &payload)
+{
+    QByteArray keyBytes = key.toUtf8();
+    quint32 recordLength = keyBytes.size() + payload.size();
+
+    QByteArray newRecord;
+    newRecord.reserve(recordPrefixSize + recordLength);
+    quint32 lengthLE = qToLittleEndian(recordLength);
+    quint32 keyLengthLE = qToLittleEndian((quint32) keyBytes.size());
+    quint32 checksum = getChecksum((const uchar *) keyBytes.constData(), keyBytes.size());
+    checksum = getChecksum((const uchar *) payload.constData(), payload.size(), checksum);
+    quint32 checksumLE = qToLittleEndian(checksum);
+    newRecord.append((const char *) &lengthLE, sizeof(lengthLE));
+    newRecord.append((const char *) &keyLengthLE, sizeof(keyLengthLE));
+    newRecord.append((const char *) &checksumLE, sizeof(checksumLE));
+    newRecord.append(keyBytes);
+    newRecord.append(payload);
+
+    qint64 recordStart = storeFile.size();
+    if (!storeFile.seek(recordStart) || (storeFile.write(newRecord) != newRecord.size()))
+    {
+        qCWarning(agaveRequests, "Unable to write to metadata store");
+        //Cut off anything partly written, so the next record starts in the right place
+        unmapStoreFile();
+        storeFile.resize(recordStart);
+        return false;
+    }
+    storeFile.flush();
+
+    auto oldRecord = recordIndex.constFind(key);
+    if (oldRecord != recordIndex.constEnd())
+    {
+        liveBytes -= oldRecord->recordLength + recordPrefixSize;
+        recordIndex.erase(oldRecord);
+    }
+
+    if (!payload.isEmpty())
+    {
+        RecordRef newRef;
+        newRef.recordLength = recordLength;
+        newRef.payloadLength = payload.size();
+        newRef.payloadOffset = recordStart + recordPrefixSize + keyBytes.size();
+        newRef.checksum = checksum;
+        recordIndex.insert(key, newRef);
+        liveBytes += recordLength + recordPrefixSize;
+    }
+    return true;
+}
+
+bool AgaveMetadataStore::readPayload(const RecordRef &theRecord, QByteArray * payload)
+{
+    //Records written since the last mapping are past its end, so the file is mapped again
+    if ((theRecord.payloadOffset + theRecord.payloadLength > mappedSize) && !mapStoreFile())
+    {
+        return false;
+    }
+    if (theRecord.payloadOffset + theRecord.payloadLength > mappedSize) return false;
+
+    *payload = QByteArray::fromRawData((const char *) mappedData + theRecord.payloadOffset, theRecord.payloadLength);
+    return true;
+}
+
+bool AgaveMetadataStore::readRecord(const QString &key, QByteArray * payload)
+{
+    auto itr = recordIndex.constFind(key);
+    if (itr == recordIndex.constEnd()) return false;
+    RecordRef theRecord = *itr;
+
+    if (!readPayload(theRecord, payload)) return false;
+
+    //The key is just before the payload, and the checksum covers both
+    qint64 keyStart = theRecord.payloadOffset - (theRecord.recordLength - theRecord.payloadLength);
+    if (getChecksum(mappedData + keyStart, theRecord.recordLength) != theRecord.checksum)
+    {
+        qCWarning(agaveRequests, "Dropping damaged metadata store record: %s", qPrintable(key));
+        dropRecord(key);
+        return false;
+    }
+    return true;
+}
+
+void AgaveMetadataStore::dropRecord(const QString &key)
+{
+    appendRecord(key, QByteArray());
+}
+
+bool AgaveMetadataStore::needsCompaction()
+{
+    qint64 fileSize = storeFile.size();
+    return ((fileSize > minCompactSize) && (fileSize > 2 * (liveBytes + storeHeaderSize)));
+}
+
+QString AgaveMetadataStore::getListingKey(QString dirPath)
+{
+    return QString("L:").append(AgaveListingCache::getCacheKey(dirPath));
+}
+
+QString AgaveMetadataStore::sanitizeFileNamePart(QString namePart)
+{
+    QString ret;
+    ret.reserve(namePart.size());
+    for (const QChar &aChar : namePart)
+    {
+        if (aChar.isLetterOrNumber() || (aChar == '.') || (aChar == '-') || (aChar == '_'))
+        {
+            ret.append(aChar);
+        }
+        else
+        {
+            ret.append('_');
+        }
+    }
+    return ret;
+}
+
+quint32 AgaveMetadataStore::getChecksum(const uchar * data, qint64 length, quint32 startValue)
+{
+    //CRC-32, as used by zip, continued from startValue
+    static quint32 crcTable[256];
+    static bool tableReady = false;
+    if (!tableReady)
+    {
+        for (quint32 i = 0; i < 256; i++)
+        {
+            quint32 tableValue = i;
+            for (int bit = 0; bit < 8; bit++)
+            {
+                tableValue = (tableValue & 1) ? (0xEDB88320u ^ (tableValue >> 1)) : (tableValue >> 1);
+            }
+            crcTable[i] = tableValue;
+        }
+        tableReady = true;
+    }
+
+    quint32 crcValue = ~startValue;
+    for (qint64 i = 0; i < length; i++)
+    {
+        crcValue = crcTable[(crcValue ^ data[i]) & 0xFF] ^ (crcValue >> 8);
+    }
+    return ~crcValue;
+}
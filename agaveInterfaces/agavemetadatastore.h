@@ -0,0 +1,122 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEMETADATASTORE_H
+#define AGAVEMETADATASTORE_H
+
+#include "../filelisting.h"
+#include "../remotejobdata.h"
+
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QFile>
+#include <QSaveFile>
+#include <QLockFile>
+#include <QScopedPointer>
+#include <QDir>
+#include <QDataStream>
+#include <QtEndian>
+
+#include <cstring>
+#include <limits>
+
+//On-disk store of the last known folder listings and job list, one file per account and storage system,
+//so a new session can show them before the first network reply arrives.
+//The file is a header followed by appended records, read through a memory mapping:
+//  [quint32 record length][quint32 key length][quint32 CRC-32 of key and payload][key, UTF-8][payload, QDataStream]
+//The latest record for a key wins, an empty payload removes the key.
+//A truncated record at the end of the file (crash during a write) is dropped on open.
+//A record which fails its checksum, or does not decode, is dropped when it is read.
+//Only one session at a time uses a store file, held with a lock file beside it. Others go without a store.
+class AgaveMetadataStore
+{
+public:
+    AgaveMetadataStore();
+    ~AgaveMetadataStore();
+
+    bool openStore(QString storeDir, QString accountName, QString storageSystem);
+    void closeStore();
+    bool isOpen();
+    QString getStoreFileName();
+
+    bool loadListing(QString dirPath, FileListing * foundListing);
+    void saveListing(QString dirPath, FileListing newListing);
+    void removeListing(QString dirPath);
+    //Removes the listing of this path and of every folder under it
+    void removeTree(QString dirPath);
+
+    bool loadJobList(QList<RemoteJobData> * foundList);
+    void saveJobList(QList<RemoteJobData> newList);
+
+    int getRecordCount();
+    //Rewrites the file with only the live records
+    bool compactStore();
+
+private:
+    struct RecordRef
+    {
+        qint64 payloadOffset;
+        quint32 payloadLength;
+        quint32 recordLength;
+        quint32 checksum;
+    };
+
+    bool mapStoreFile();
+    void unmapStoreFile();
+    bool readIndex();
+    bool writeHeader();
+    bool appendRecord(const QString &key, const QByteArray &payload);
+    bool readPayload(const RecordRef &theRecord, QByteArray * payload);
+    //Looks up and checks a record, a damaged one is removed
+    bool readRecord(const QString &key, QByteArray * payload);
+    void dropRecord(const QString &key);
+    bool needsCompaction();
+
+    static QString getListingKey(QString dirPath);
+    static QString sanitizeFileNamePart(QString namePart);
+    static quint32 getChecksum(const uchar * data, qint64 length, quint32 startValue = 0);
+
+    QFile storeFile;
+    QScopedPointer<QLockFile> storeLock;
+    uchar * mappedData = NULL;
+    qint64 mappedSize = 0;
+
+    QHash<QString, RecordRef> recordIndex;
+    qint64 liveBytes = 0;
+};
+
+#endif // AGAVEMETADATASTORE_H
@@ -0,0 +1,203 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavenotificationlistener.h"
+#include "agavelogging.h"
+
+AgaveNotificationListener::AgaveNotificationListener(QObject * parent) : QObject(parent)
+{
+    QObject::connect(&callbackServer, SIGNAL(newConnection()), this, SLOT(acceptConnection()));
+}
+
+AgaveNotificationListener::~AgaveNotificationListener()
+{
+    stopListening();
+}
+
+bool AgaveNotificationListener::startListening(QString publicHost, quint16 port)
+{
+    stopListening();
+    if (publicHost.isEmpty()) return false;
+
+    if (!callbackServer.listen(QHostAddress::Any, port))
+    {
+        qCWarning(agaveRequests, "Unable to listen for job notifications: %s", qPrintable(callbackServer.errorString()));
+        return false;
+    }
+
+    callbackHost = publicHost;
+    callbackToken = QUuid::createUuid().toString().remove('{').remove('}').remove('-');
+    qCDebug(agaveRequests, "Listening for job notifications on port %d", (int) callbackServer.serverPort());
+    return true;
+}
+
+void AgaveNotificationListener::stopListening()
+{
+    callbackServer.close();
+    for (auto itr = pendingRequests.constBegin(); itr != pendingRequests.constEnd(); itr++)
+    {
+        itr.key()->disconnect(this);
+        itr.key()->abort();
+        itr.key()->deleteLater();
+    }
+    pendingRequests.clear();
+    callbackToken.clear();
+}
+
+bool AgaveNotificationListener::isListening()
+{
+    return callbackServer.isListening();
+}
+
+QString AgaveNotificationListener::getCallbackURL()
+{
+    if (!isListening()) return QString();
+
+    //The macros are left unencoded, Agave replaces them before sending
+    return QString("http://%1:%2/agave/job?token=%3&id=${JOB_ID}&status=${JOB_STATUS}")
+            .arg(callbackHost).arg(callbackServer.serverPort()).arg(callbackToken);
+}
+
+int AgaveNotificationListener::getEventCount()
+{
+    return eventCount;
+}
+
+void AgaveNotificationListener::acceptConnection()
+{
+    while (callbackServer.hasPendingConnections())
+    {
+        QTcpSocket * newSocket = callbackServer.nextPendingConnection();
+        pendingRequests.insert(newSocket, QByteArray());
+        QObject::connect(newSocket, SIGNAL(readyRead()), this, SLOT(readRequestData()));
+        QObject::connect(newSocket, SIGNAL(disconnected()), this, SLOT(dropConnection()));
+    }
+}
+
+void AgaveNotificationListener::readRequestData()
+{
+    QTcpSocket * theSocket = qobject_cast<QTcpSocket *>(QObject::sender());
+    if ((theSocket == NULL) || !pendingRequests.contains(theSocket)) return;
+
+    QByteArray &requestData = pendingRequests[theSocket];
+    requestData.append(theSocket->readAll());
+
+    if (requestData.size() > maxRequestSize)
+    {
+        sendResponse(theSocket, "HTTP/1.1 413 Payload Too Large");
+        return;
+    }
+
+    int headerEnd = requestData.indexOf("\r\n\r\n");
+    if (headerEnd < 0) return;
+
+    //Wait for the whole body, if there is one
+    int contentLength = 0;
+    QList<QByteArray> headerLines = requestData.left(headerEnd).split('\n');
+    for (auto itr = headerLines.constBegin(); itr != headerLines.constEnd(); itr++)
+    {
+        if ((*itr).toLower().startsWith("content-length:"))
+        {
+            contentLength = (*itr).mid(15).trimmed().toInt();
+        }
+    }
+    if (requestData.size() < headerEnd + 4 + contentLength) return;
+
+    if (processRequest(theSocket, requestData))
+    {
+        sendResponse(theSocket, "HTTP/1.1 200 OK");
+    }
+    else
+    {
+        sendResponse(theSocket, "HTTP/1.1 400 Bad Request");
+    }
+}
+
+void AgaveNotificationListener::dropConnection()
+{
+    QTcpSocket * theSocket = qobject_cast<QTcpSocket *>(QObject::sender());
+    if (theSocket == NULL) return;
+
+    pendingRequests.remove(theSocket);
+    theSocket->deleteLater();
+}
+
+bool AgaveNotificationListener::processRequest(QTcpSocket *, const QByteArray &requestData)
+{
+    int lineEnd = requestData.indexOf("\r\n");
+    QList<QByteArray> requestLine = requestData.left(lineEnd).split(' ');
+    if (requestLine.size() < 2) return false;
+
+    QUrl requestURL(QString("http://localhost").append(QString::fromLatin1(requestLine.at(1))));
+    QUrlQuery requestQuery(requestURL);
+
+    if (callbackToken.isEmpty() || (requestQuery.queryItemValue("token") != callbackToken))
+    {
+        qCWarning(agaveRequests, "Job notification refused: bad token");
+        return false;
+    }
+
+    QString jobID = requestQuery.queryItemValue("id");
+    QString jobState = requestQuery.queryItemValue("status");
+
+    //Agave also posts the job itself, which is used if the macros were not filled in
+    if (jobID.isEmpty() || jobID.startsWith('$') || jobState.isEmpty() || jobState.startsWith('$'))
+    {
+        QJsonObject jobObject = QJsonDocument::fromJson(requestData.mid(requestData.indexOf("\r\n\r\n") + 4)).object();
+        jobID = jobObject.value("id").toString();
+        jobState = jobObject.value("status").toString();
+    }
+    if (jobID.isEmpty() || jobState.isEmpty()) return false;
+
+    eventCount++;
+    qCDebug(agaveReplies, "Job notification: %s is %s", qPrintable(jobID), qPrintable(jobState));
+    emit jobEventReceived(jobID, jobState);
+    return true;
+}
+
+void AgaveNotificationListener::sendResponse(QTcpSocket * theSocket, QByteArray statusLine)
+{
+    pendingRequests.remove(theSocket);
+    theSocket->disconnect(this);
+
+    statusLine.append("\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+    theSocket->write(statusLine);
+    QObject::connect(theSocket, SIGNAL(disconnected()), theSocket, SLOT(deleteLater()));
+    theSocket->disconnectFromHost();
+    if (theSocket->state() == QAbstractSocket::UnconnectedState)
+    {
+        theSocket->deleteLater();
+    }
+}
@@ -0,0 +1,94 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVENOTIFICATIONLISTENER_H
+#define AGAVENOTIFICATIONLISTENER_H
+
+#include <QObject>
+#include <QString>
+#include <QByteArray>
+#include <QHash>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QUrl>
+#include <QUrlQuery>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QUuid>
+
+//Minimal HTTP listener for Agave job notification callbacks
+//Jobs submitted while listening carry a notification to getCallbackURL(), which Agave fills in
+//with the job ID and status. Callbacks without the listener's token are refused.
+//The public host must be an address at which the Agave tenant can reach this machine.
+class AgaveNotificationListener : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveNotificationListener(QObject * parent = 0);
+    ~AgaveNotificationListener();
+
+    //Port 0 picks any free port
+    bool startListening(QString publicHost, quint16 port = 0);
+    void stopListening();
+    bool isListening();
+
+    //Includes Agave's ${JOB_ID} and ${JOB_STATUS} macros
+    QString getCallbackURL();
+    int getEventCount();
+
+signals:
+    void jobEventReceived(QString jobID, QString jobState);
+
+private slots:
+    void acceptConnection();
+    void readRequestData();
+    void dropConnection();
+
+private:
+    bool processRequest(QTcpSocket * theSocket, const QByteArray &requestData);
+    void sendResponse(QTcpSocket * theSocket, QByteArray statusLine);
+
+    QTcpServer callbackServer;
+    QHash<QTcpSocket *, QByteArray> pendingRequests;
+
+    QString callbackHost;
+    QString callbackToken;
+    int eventCount = 0;
+
+    const int maxRequestSize = 65536;
+};
+
+#endif // AGAVENOTIFICATIONLISTENER_H
@@ -0,0 +1,175 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agaveparametersweep.h"
+
+AgaveParameterSweep::AgaveParameterSweep()
+{
+
+}
+
+void AgaveParameterSweep::setFixedValue(QString name, QString value)
+{
+    fixedValues.insert(name, value);
+}
+
+void AgaveParameterSweep::addValueList(QString name, QStringList values)
+{
+    SweepAxis newAxis;
+    newAxis.name = name;
+    newAxis.values = values;
+    newAxis.isRange = false;
+    newAxis.start = 0;
+    newAxis.step = 0;
+    newAxis.count = values.size();
+    sweepAxes.append(newAxis);
+}
+
+void AgaveParameterSweep::addRange(QString name, double start, double stop, double step)
+{
+    SweepAxis newAxis;
+    newAxis.name = name;
+    newAxis.isRange = true;
+    newAxis.start = start;
+    newAxis.step = step;
+    newAxis.count = 0;
+
+    if ((step != 0) && ((stop - start) / step >= 0))
+    {
+        //A small tolerance, so 0 to 1 by 0.1 has 11 points
+        newAxis.count = (qint64)((stop - start) / step + 1e-9) + 1;
+    }
+    else if (start == stop)
+    {
+        newAxis.count = 1;
+    }
+    sweepAxes.append(newAxis);
+}
+
+QStringList AgaveParameterSweep::getParameterNames() const
+{
+    QStringList ret = fixedValues.uniqueKeys();
+    for (auto itr = sweepAxes.cbegin(); itr != sweepAxes.cend(); itr++)
+    {
+        if (!ret.contains(itr->name))
+        {
+            ret.append(itr->name);
+        }
+    }
+    return ret;
+}
+
+qint64 AgaveParameterSweep::getPointCount() const
+{
+    if (sweepAxes.isEmpty()) return 0;
+
+    qint64 ret = 1;
+    for (auto itr = sweepAxes.cbegin(); itr != sweepAxes.cend(); itr++)
+    {
+        if (itr->count == 0) return 0;
+        if (ret > std::numeric_limits<qint64>::max() / itr->count) return -1;
+        ret *= itr->count;
+    }
+    return ret;
+}
+
+QMultiMap<QString, QString> AgaveParameterSweep::getPoint(qint64 index) const
+{
+    QMultiMap<QString, QString> ret = fixedValues;
+
+    //Mixed radix digits of the index, last axis first
+    for (int i = sweepAxes.size() - 1; i >= 0; i--)
+    {
+        const SweepAxis &theAxis = sweepAxes.at(i);
+        if (theAxis.count <= 0) return QMultiMap<QString, QString>();
+
+        ret.insert(theAxis.name, getAxisValue(theAxis, index % theAxis.count));
+        index /= theAxis.count;
+    }
+    return ret;
+}
+
+QString AgaveParameterSweep::getAxisValue(const SweepAxis &theAxis, qint64 index) const
+{
+    if (!theAxis.isRange)
+    {
+        return theAxis.values.at((int) index);
+    }
+
+    //Computed from the start each time, so rounding errors do not add up along the range
+    //15 digits hides what is left of them (0.1 * 3 gives "0.3")
+    double theValue = theAxis.start + theAxis.step * index;
+    return QLocale::c().toString(theValue, 'g', 15);
+}
+
+QByteArray AgaveParameterSweep::getSweepHash() const
+{
+    //Each field is length prefixed, so no two different sweeps give the same input
+    QCryptographicHash sweepHash(QCryptographicHash::Sha256);
+    for (const SweepAxis &anAxis : sweepAxes)
+    {
+        addHashField(&sweepHash, anAxis.name);
+        if (anAxis.isRange)
+        {
+            addHashField(&sweepHash, "range");
+            addHashField(&sweepHash, QString::number(anAxis.start, 'g', 17));
+            addHashField(&sweepHash, QString::number(anAxis.step, 'g', 17));
+            addHashField(&sweepHash, QString::number(anAxis.count));
+        }
+        else
+        {
+            addHashField(&sweepHash, "list");
+            addHashField(&sweepHash, QString::number(anAxis.values.size()));
+            for (const QString &aValue : anAxis.values)
+            {
+                addHashField(&sweepHash, aValue);
+            }
+        }
+    }
+    addHashField(&sweepHash, "fixed");
+    for (auto itr = fixedValues.constBegin(); itr != fixedValues.constEnd(); itr++)
+    {
+        addHashField(&sweepHash, itr.key());
+        addHashField(&sweepHash, itr.value());
+    }
+    return sweepHash.result().toHex();
+}
+
+void AgaveParameterSweep::addHashField(QCryptographicHash * theHash, const QString &aField)
+{
+    QByteArray fieldData = aField.toUtf8();
+    theHash->addData(QByteArray::number(fieldData.size()).append(':'));
+    theHash->addData(fieldData);
+}
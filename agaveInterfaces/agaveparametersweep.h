@@ -0,0 +1,88 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVEPARAMETERSWEEP_H
+#define AGAVEPARAMETERSWEEP_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QMultiMap>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QLocale>
+
+#include <limits>
+
+//Describes a parameter sweep: the Cartesian product of a number of axes,
+//each a list of values or a numeric range, plus values common to every job
+//Points are computed from their index on demand, so no sweep is ever held in memory
+//The last axis added varies fastest.
+class AgaveParameterSweep
+{
+public:
+    AgaveParameterSweep();
+
+    void setFixedValue(QString name, QString value);
+    void addValueList(QString name, QStringList values);
+    //From start to stop inclusive, stop is included if it falls on a step
+    void addRange(QString name, double start, double stop, double step);
+
+    QStringList getParameterNames() const;
+    //-1 if the sweep is too large to count
+    qint64 getPointCount() const;
+    QMultiMap<QString, QString> getPoint(qint64 index) const;
+    //Hex hash of the axes, their values and the fixed values, the same for the same sweep in any session
+    QByteArray getSweepHash() const;
+
+private:
+    struct SweepAxis
+    {
+        QString name;
+        QStringList values;
+        bool isRange;
+        double start;
+        double step;
+        qint64 count;
+    };
+
+    QString getAxisValue(const SweepAxis &theAxis, qint64 index) const;
+    static void addHashField(QCryptographicHash * theHash, const QString &aField);
+
+    QList<SweepAxis> sweepAxes;
+    QMultiMap<QString, QString> fixedValues;
+};
+
+#endif // AGAVEPARAMETERSWEEP_H
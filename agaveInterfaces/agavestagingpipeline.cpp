@@ -0,0 +1,267 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavestagingpipeline.h"
+#include "agavehandler.h"
+#include "agavejsonkeypath.h"
+#include "agavelogging.h"
+
+#include "../filemetadata.h"
+
+AgaveStagingPipeline::AgaveStagingPipeline(AgaveHandler * theManager, int maxUploads) : QObject((QObject *)theManager)
+{
+    myManager = theManager;
+    maxInFlightUploads = qMax(maxUploads, 1);
+}
+
+int AgaveStagingPipeline::addStagedJob(QString jobName, QMultiMap<QString, QString> jobParameters, QMultiMap<QString, QString> inputFiles,
+                                       QString remoteStagingDir, QString remoteWorkingDir, bool makeStagingDir)
+{
+    if (myManager->getAgaveJobTemplate(jobName).isEmpty())
+    {
+        return -1;
+    }
+
+    int stageID = nextStageID;
+    nextStageID++;
+
+    StagedJob newJob;
+    newJob.jobName = jobName;
+    newJob.jobParameters = jobParameters;
+    newJob.remoteStagingDir = remoteStagingDir;
+    newJob.remoteWorkingDir = remoteWorkingDir;
+    newJob.uploadsLeft = inputFiles.size();
+    newJob.stagingDirReady = !makeStagingDir;
+    newJob.stagingFailed = false;
+    stagedJobs.insert(stageID, newJob);
+
+    for (auto itr = inputFiles.cbegin(); itr != inputFiles.cend(); itr++)
+    {
+        PendingUpload newUpload;
+        newUpload.stageID = stageID;
+        newUpload.inputName = itr.key();
+        newUpload.localFile = itr.value();
+        uploadQueue.append(newUpload);
+    }
+
+    if (makeStagingDir)
+    {
+        QString cleanDir = remoteStagingDir;
+        while ((cleanDir.size() > 1) && cleanDir.endsWith('/'))
+        {
+            cleanDir.chop(1);
+        }
+        int lastSlash = cleanDir.lastIndexOf('/');
+        QString parentDir = (lastSlash < 0) ? QString() : ((lastSlash == 0) ? QString("/") : cleanDir.left(lastSlash));
+        QString newName = cleanDir.mid(lastSlash + 1);
+
+        RemoteDataReply * dirReply = myManager->mkRemoteDir(parentDir, newName);
+        if (dirReply == NULL)
+        {
+            stagedJobs[stageID].stagingDirReady = true;
+            stagedJobs[stageID].stagingFailed = true;
+        }
+        else
+        {
+            inFlightDirs.insert(dirReply, stageID);
+            QObject::connect(dirReply, SIGNAL(haveMkdirResult(RequestState,FileMetaData)),
+                             this, SLOT(stagingDirDone(RequestState,FileMetaData)));
+        }
+    }
+
+    if (inputFiles.isEmpty() && stagedJobs.value(stageID).stagingDirReady)
+    {
+        inputsDone(stageID);
+    }
+    else
+    {
+        startUploads();
+    }
+    return stageID;
+}
+
+int AgaveStagingPipeline::getPendingJobCount()
+{
+    return stagedJobs.size();
+}
+
+void AgaveStagingPipeline::stagingDirDone(RequestState replyState, FileMetaData)
+{
+    auto itr = inFlightDirs.find(QObject::sender());
+    if (itr == inFlightDirs.end()) return;
+    int stageID = *itr;
+    inFlightDirs.erase(itr);
+
+    auto jobItr = stagedJobs.find(stageID);
+    if (jobItr == stagedJobs.end()) return;
+
+    jobItr->stagingDirReady = true;
+    if (replyState != RequestState::GOOD)
+    {
+        //The folder may already be there, in which case the uploads still succeed
+        qCDebug(agaveReplies, "Staging folder not created: %s", qPrintable(jobItr->remoteStagingDir));
+    }
+
+    if (jobItr->uploadsLeft == 0)
+    {
+        inputsDone(stageID);
+    }
+    startUploads();
+}
+
+void AgaveStagingPipeline::uploadDone(RequestState replyState, FileMetaData newFile)
+{
+    auto itr = inFlightUploads.find(QObject::sender());
+    if (itr == inFlightUploads.end()) return;
+    PendingUpload doneUpload = *itr;
+    inFlightUploads.erase(itr);
+
+    auto jobItr = stagedJobs.find(doneUpload.stageID);
+    if (jobItr != stagedJobs.end())
+    {
+        jobItr->uploadsLeft--;
+        if (replyState == RequestState::GOOD)
+        {
+            jobItr->jobParameters.insert(doneUpload.inputName, myManager->getAgaveFileURL(newFile.getFullPath()));
+            emit inputStaged(doneUpload.stageID, doneUpload.inputName, replyState, newFile.getFullPath());
+        }
+        else
+        {
+            jobItr->stagingFailed = true;
+            emit inputStaged(doneUpload.stageID, doneUpload.inputName, replyState, QString());
+        }
+
+        if (jobItr->uploadsLeft == 0)
+        {
+            inputsDone(doneUpload.stageID);
+        }
+    }
+    startUploads();
+}
+
+void AgaveStagingPipeline::submitDone(RequestState replyState, QJsonDocument rawJobReply)
+{
+    static const AgaveJSONKeyPath jobIDPath({"result", "id"});
+
+    auto itr = inFlightSubmits.find(QObject::sender());
+    if (itr == inFlightSubmits.end()) return;
+    int stageID = *itr;
+    inFlightSubmits.erase(itr);
+
+    QString jobID;
+    if (replyState == RequestState::GOOD)
+    {
+        jobID = jobIDPath.retriveValue(rawJobReply.object()).toString();
+        if (jobID.isEmpty())
+        {
+            replyState = RequestState::FAIL;
+        }
+    }
+    finishJob(stageID, replyState, jobID);
+}
+
+void AgaveStagingPipeline::startUploads()
+{
+    //Uploads go in queue order, except those waiting for their staging folder
+    for (int i = 0; (i < uploadQueue.size()) && (inFlightUploads.size() < maxInFlightUploads);)
+    {
+        PendingUpload nextUpload = uploadQueue.at(i);
+        auto jobItr = stagedJobs.find(nextUpload.stageID);
+        if ((jobItr != stagedJobs.end()) && !jobItr->stagingDirReady)
+        {
+            i++;
+            continue;
+        }
+        uploadQueue.removeAt(i);
+        if (jobItr == stagedJobs.end()) continue;
+
+        RemoteDataReply * uploadReply = NULL;
+        if (!jobItr->stagingFailed)
+        {
+            uploadReply = myManager->uploadFile(jobItr->remoteStagingDir, nextUpload.localFile);
+        }
+        if (uploadReply == NULL)
+        {
+            //Once one input fails, the job cannot start, so its other inputs are not uploaded
+            if (!jobItr->stagingFailed)
+            {
+                emit inputStaged(nextUpload.stageID, nextUpload.inputName, RequestState::FAIL, QString());
+            }
+            jobItr->stagingFailed = true;
+            jobItr->uploadsLeft--;
+            if (jobItr->uploadsLeft == 0)
+            {
+                inputsDone(nextUpload.stageID);
+            }
+            continue;
+        }
+
+        inFlightUploads.insert(uploadReply, nextUpload);
+        QObject::connect(uploadReply, SIGNAL(haveUploadResult(RequestState,FileMetaData)),
+                         this, SLOT(uploadDone(RequestState,FileMetaData)));
+    }
+}
+
+void AgaveStagingPipeline::inputsDone(int stageID)
+{
+    auto jobItr = stagedJobs.find(stageID);
+    if (jobItr == stagedJobs.end()) return;
+
+    if (jobItr->stagingFailed)
+    {
+        finishJob(stageID, RequestState::FAIL, QString());
+        return;
+    }
+
+    RemoteDataReply * jobReply = myManager->runRemoteJob(jobItr->jobName, jobItr->jobParameters, jobItr->remoteWorkingDir);
+    if (jobReply == NULL)
+    {
+        finishJob(stageID, RequestState::FAIL, QString());
+        return;
+    }
+    inFlightSubmits.insert(jobReply, stageID);
+    QObject::connect(jobReply, SIGNAL(haveJobResult(RequestState,QJsonDocument)),
+                     this, SLOT(submitDone(RequestState,QJsonDocument)));
+}
+
+void AgaveStagingPipeline::finishJob(int stageID, RequestState replyState, QString jobID)
+{
+    stagedJobs.remove(stageID);
+    emit jobStarted(stageID, replyState, jobID);
+    if (stagedJobs.isEmpty())
+    {
+        emit allJobsStarted();
+    }
+}
@@ -0,0 +1,115 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVESTAGINGPIPELINE_H
+#define AGAVESTAGINGPIPELINE_H
+
+#include "../remotedatainterface.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QList>
+#include <QMultiMap>
+#include <QFileInfo>
+#include <QJsonDocument>
+
+class AgaveHandler;
+class FileMetaData;
+
+//Uploads the input files of jobs and starts each job as soon as its last input is uploaded
+//Uploads of all staged jobs share one window of maxUploads, in the order the jobs were added,
+//so the inputs of the next job upload while the job before it is submitted.
+//Each uploaded input is given to the job as an agave:// URL.
+class AgaveStagingPipeline : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveStagingPipeline(AgaveHandler * theManager, int maxUploads = 4);
+
+    //inputFiles maps app input names to local files, which are uploaded to remoteStagingDir
+    //If makeStagingDir is set, remoteStagingDir is created first
+    //Returns an ID for this job's signals, or -1 if the job cannot be staged
+    int addStagedJob(QString jobName, QMultiMap<QString, QString> jobParameters, QMultiMap<QString, QString> inputFiles,
+                     QString remoteStagingDir, QString remoteWorkingDir = "", bool makeStagingDir = false);
+
+    int getPendingJobCount();
+
+signals:
+    void inputStaged(int stageID, QString inputName, RequestState replyState, QString remotePath);
+    void jobStarted(int stageID, RequestState replyState, QString jobID);
+    void allJobsStarted();
+
+private slots:
+    void stagingDirDone(RequestState replyState, FileMetaData newFolder);
+    void uploadDone(RequestState replyState, FileMetaData newFile);
+    void submitDone(RequestState replyState, QJsonDocument rawJobReply);
+
+private:
+    struct StagedJob
+    {
+        QString jobName;
+        QMultiMap<QString, QString> jobParameters;
+        QString remoteStagingDir;
+        QString remoteWorkingDir;
+        int uploadsLeft;
+        bool stagingDirReady;
+        bool stagingFailed;
+    };
+
+    struct PendingUpload
+    {
+        int stageID;
+        QString inputName;
+        QString localFile;
+    };
+
+    void startUploads();
+    void inputsDone(int stageID);
+    void finishJob(int stageID, RequestState replyState, QString jobID);
+
+    AgaveHandler * myManager = NULL;
+    int maxInFlightUploads;
+
+    QHash<int, StagedJob> stagedJobs;
+    QList<PendingUpload> uploadQueue;
+    QHash<QObject *, PendingUpload> inFlightUploads;
+    QHash<QObject *, int> inFlightDirs;
+    QHash<QObject *, int> inFlightSubmits;
+    int nextStageID = 0;
+};
+
+#endif // AGAVESTAGINGPIPELINE_H
@@ -0,0 +1,163 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavesweepreply.h"
+#include "agavelogging.h"
+
+AgaveSweepReply::AgaveSweepReply(AgaveHandler * theManager, QString jobName, QJsonObject jobTemplate, QString remoteWorkingDir,
+                                 int maxInFlight, AgaveParameterSweep theSweep, QObject * parent) :
+    AgaveJobBatchReply(theManager, jobName, jobTemplate, remoteWorkingDir, maxInFlight, parent)
+{
+    mySweep = theSweep;
+    mySweepName = jobName;
+    pointCount = qMax(mySweep.getPointCount(), (qint64) 0);
+}
+
+AgaveSweepReply::~AgaveSweepReply()
+{
+    if (checkpointFile.isOpen())
+    {
+        checkpointFile.close();
+    }
+}
+
+bool AgaveSweepReply::setCheckpointFile(QString fileName)
+{
+    completedPoints.clear();
+    checkpointFile.setFileName(fileName);
+
+    //Each line after the header is: point index, tab, job ID
+    bool keepOldFile = false;
+    if (checkpointFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        QTextStream checkpointStream(&checkpointFile);
+        if (checkpointStream.readLine() == getCheckpointHeader())
+        {
+            keepOldFile = true;
+            while (!checkpointStream.atEnd())
+            {
+                QString aLine = checkpointStream.readLine();
+                bool indexOK = false;
+                qint64 pointIndex = aLine.section('\t', 0, 0).toLongLong(&indexOK);
+                if (indexOK && (pointIndex >= 0) && (pointIndex < pointCount))
+                {
+                    completedPoints.insert(pointIndex);
+                }
+            }
+        }
+        else
+        {
+            qCWarning(agaveRequests, "Checkpoint file is for a different sweep, starting over: %s", qPrintable(fileName));
+        }
+        checkpointFile.close();
+    }
+
+    if (keepOldFile)
+    {
+        if (!checkpointFile.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) return false;
+    }
+    else
+    {
+        if (!checkpointFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) return false;
+        checkpointFile.write(getCheckpointHeader().toUtf8().append('\n'));
+        checkpointFile.flush();
+    }
+    return true;
+}
+
+void AgaveSweepReply::setSubmitInterval(int msecs)
+{
+    submitInterval = qMax(msecs, 0);
+}
+
+qint64 AgaveSweepReply::getPointCount()
+{
+    return pointCount;
+}
+
+int AgaveSweepReply::getResumedCount()
+{
+    return completedPoints.size();
+}
+
+bool AgaveSweepReply::takeNextJob(int * jobIndex, QMultiMap<QString, QString> * jobParameters)
+{
+    if (!hasMoreJobs() || submitWaiting) return false;
+
+    if ((submitInterval > 0) && submitClock.isValid() && (submitClock.elapsed() < submitInterval))
+    {
+        submitWaiting = true;
+        QTimer::singleShot(submitInterval - (int) submitClock.elapsed(), this, SLOT(submitIntervalElapsed()));
+        return false;
+    }
+    submitClock.start();
+
+    *jobIndex = (int) nextPoint;
+    *jobParameters = mySweep.getPoint(nextPoint);
+    nextPoint++;
+    return true;
+}
+
+bool AgaveSweepReply::hasMoreJobs()
+{
+    while ((nextPoint < pointCount) && completedPoints.contains(nextPoint))
+    {
+        nextPoint++;
+    }
+    return (nextPoint < pointCount);
+}
+
+void AgaveSweepReply::recordJobResult(int jobIndex, RequestState replyState, QString jobID)
+{
+    if ((replyState == RequestState::GOOD) && checkpointFile.isOpen())
+    {
+        //Written at once. Jobs still being submitted at a crash are not recorded, so they are submitted again on resume
+        checkpointFile.write(QString("%1\t%2\n").arg(jobIndex).arg(jobID).toUtf8());
+        checkpointFile.flush();
+    }
+    AgaveJobBatchReply::recordJobResult(jobIndex, replyState, jobID);
+}
+
+void AgaveSweepReply::submitIntervalElapsed()
+{
+    submitWaiting = false;
+    submitMoreJobs();
+}
+
+QString AgaveSweepReply::getCheckpointHeader()
+{
+    //A checkpoint is only reused for the same app, axes and values
+    return QString("#AgaveSweep\t%1\t%2\t%3").arg(mySweepName).arg(pointCount).arg(QString::fromLatin1(mySweep.getSweepHash()));
+}
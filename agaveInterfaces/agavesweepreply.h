@@ -0,0 +1,90 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVESWEEPREPLY_H
+#define AGAVESWEEPREPLY_H
+
+#include "agavejobbatchreply.h"
+#include "agaveparametersweep.h"
+
+#include <QSet>
+#include <QFile>
+#include <QTextStream>
+#include <QElapsedTimer>
+
+//Reply for AgaveHandler::runParameterSweep
+//A job batch whose jobs are the points of a sweep, made one at a time as they are submitted.
+//Job indexes are point indexes. With a checkpoint file, each submitted point is recorded
+//with its job ID, and points already in the file are skipped, so an interrupted sweep can be resumed.
+class AgaveSweepReply : public AgaveJobBatchReply
+{
+    Q_OBJECT
+public:
+    explicit AgaveSweepReply(AgaveHandler * theManager, QString jobName, QJsonObject jobTemplate, QString remoteWorkingDir,
+                             int maxInFlight, AgaveParameterSweep theSweep, QObject * parent = 0);
+    ~AgaveSweepReply();
+
+    bool setCheckpointFile(QString fileName);
+    //Least time between two submissions, 0 for none
+    void setSubmitInterval(int msecs);
+
+    qint64 getPointCount();
+    int getResumedCount();
+
+protected:
+    virtual bool takeNextJob(int * jobIndex, QMultiMap<QString, QString> * jobParameters);
+    virtual bool hasMoreJobs();
+    virtual void recordJobResult(int jobIndex, RequestState replyState, QString jobID);
+
+private slots:
+    void submitIntervalElapsed();
+
+private:
+    QString getCheckpointHeader();
+
+    AgaveParameterSweep mySweep;
+    QString mySweepName;
+    qint64 pointCount = 0;
+    qint64 nextPoint = 0;
+    QSet<qint64> completedPoints;
+
+    QFile checkpointFile;
+
+    int submitInterval = 0;
+    QElapsedTimer submitClock;
+    bool submitWaiting = false;
+};
+
+#endif // AGAVESWEEPREPLY_H
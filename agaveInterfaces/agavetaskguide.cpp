@@ -94,6 +94,26 @@ bool AgaveTaskGuide::isInternal()
     return internalTask;
 }
 
+void AgaveTaskGuide::setAsSensitive()
+{
+    sensitiveTask = true;
+}
+
+bool AgaveTaskGuide::isSensitive()
+{
+    return sensitiveTask;
+}
+
+void AgaveTaskGuide::setAsConditional()
+{
+    conditionalTask = true;
+}
+
+bool AgaveTaskGuide::isConditional()
+{
+    return conditionalTask;
+}
+
 QByteArray AgaveTaskGuide::fillPostArgList(QStringList * argList)
 {
     return fillAnyArgList(argList, numPostVals, postFormat);
@@ -159,6 +179,27 @@ bool AgaveTaskGuide::usesURLParams()
     return needsURLParams;
 }
 
+void AgaveTaskGuide::setResponseFilter(QStringList fieldList)
+{
+    if (fieldList.isEmpty())
+    {
+        responseFilterQuery = "";
+        return;
+    }
+    responseFilterQuery = "filter=";
+    responseFilterQuery.append(fieldList.join(',').toLatin1());
+}
+
+bool AgaveTaskGuide::usesResponseFilter()
+{
+    return !responseFilterQuery.isEmpty();
+}
+
+QByteArray AgaveTaskGuide::getResponseFilterQuery()
+{
+    return responseFilterQuery;
+}
+
 void AgaveTaskGuide::setAgaveFullName(QString newFullName)
 {
     agaveFullName = newFullName;
@@ -172,11 +213,21 @@ void AgaveTaskGuide::setAgavePWDparam(QString newPWDparam)
 void AgaveTaskGuide::setAgaveParamList(QStringList newParamList)
 {
     agaveParamList = newParamList;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    agaveParamSet = QSet<QString>(newParamList.begin(), newParamList.end());
+#else
+    agaveParamSet = newParamList.toSet();
+#endif
 }
 
 void AgaveTaskGuide::setAgaveInputList(QStringList newInputList)
 {
     agaveInputList = newInputList;
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+    agaveInputSet = QSet<QString>(newInputList.begin(), newInputList.end());
+#else
+    agaveInputSet = newInputList.toSet();
+#endif
 }
 
 QString AgaveTaskGuide::getAgaveFullName()
@@ -198,3 +249,13 @@ QStringList AgaveTaskGuide::getAgaveInputList()
 {
     return agaveInputList;
 }
+
+bool AgaveTaskGuide::isAgaveParam(const QString &paramName)
+{
+    return agaveParamSet.contains(paramName);
+}
+
+bool AgaveTaskGuide::isAgaveInput(const QString &inputName)
+{
+    return agaveInputSet.contains(inputName);
+}
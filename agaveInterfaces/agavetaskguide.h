@@ -40,6 +40,7 @@
 #include <QString>
 #include <QStringList>
 #include <QList>
+#include <QSet>
 
 enum class AgaveRequestType;
 enum class AgaveState;
@@ -60,12 +61,18 @@ public:
     void setDynamicURLParams(QString format, int numSubs);
     void setPostParams(QString format, int numSubs);
     void setAsInternal();
+    void setAsSensitive(); //Request or reply carries credentials, payloads are never logged
 
     void setAgaveFullName(QString newFullName);
     void setAgavePWDparam(QString newPWDparam);
     void setAgaveParamList(QStringList newParamList);
     void setAgaveInputList(QStringList newInputList);
 
+    //Fields of the reply JSON which are actually read, sent as Agave's filter= parameter on GET requests
+    void setResponseFilter(QStringList fieldList);
+    //GET replies are kept with their ETag/Last-Modified, and later requests are sent as conditional requests
+    void setAsConditional();
+
     QString getTaskID();
     QString getURLsuffix();
     AgaveRequestType getRequestType();
@@ -74,15 +81,22 @@ public:
     QByteArray fillURLArgList(QStringList * argList = NULL);
     bool isTokenFormat();
     bool isInternal();
+    bool isSensitive();
+    bool isConditional();
 
     QString getAgaveFullName();
     QString getAgavePWDparam();
     QStringList getAgaveParamList();
     QStringList getAgaveInputList();
+    bool isAgaveParam(const QString &paramName);
+    bool isAgaveInput(const QString &inputName);
 
     bool usesPostParms();
     bool usesURLParams();
 
+    bool usesResponseFilter();
+    QByteArray getResponseFilterQuery();
+
 private:
     QString taskId;
 
@@ -93,6 +107,8 @@ private:
     QByteArray fillAnyArgList(QStringList *argList, int numVals, QString strFormat);
 
     bool internalTask = false;
+    bool sensitiveTask = false;
+    bool conditionalTask = false;
     bool usesTokenFormat = false;
     bool needsPostParams = false;
     bool needsURLParams = false;
@@ -107,6 +123,10 @@ private:
     QString agavePWDparam;
     QStringList agaveParamList;
     QStringList agaveInputList;
+    QSet<QString> agaveParamSet;
+    QSet<QString> agaveInputSet;
+
+    QByteArray responseFilterQuery = "";
 };
 
 #endif // AGAVETASKGUIDE_H
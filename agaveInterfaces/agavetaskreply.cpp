@@ -36,8 +36,11 @@
 #include "agavetaskreply.h"
 #include "agavetaskguide.h"
 #include "agavehandler.h"
+#include "agavelogging.h"
+#include "agavejsonkeypath.h"
 
 #include "../AgaveClientInterface/filemetadata.h"
+#include "../AgaveClientInterface/filelisting.h"
 #include "../AgaveClientInterface/remotejobdata.h"
 
 AgaveTaskReply::AgaveTaskReply(AgaveTaskGuide * theGuide, QNetworkReply * newReply, AgaveHandler *theManager, QObject *parent) : RemoteDataReply(parent)
@@ -112,6 +115,16 @@ void AgaveTaskReply::delayedPassThruReply(RequestState replyState, QString * par
     quickTimer->start(1);
 }
 
+void AgaveTaskReply::setPassThruListing(FileListing newListing)
+{
+    pendingListing = newListing;
+}
+
+void AgaveTaskReply::setPassThruJobList(QList<RemoteJobData> newJobList)
+{
+    pendingJobList = newJobList;
+}
+
 void AgaveTaskReply::invokePassThruReply()
 {
     this->deleteLater();
@@ -123,6 +136,7 @@ void AgaveTaskReply::invokePassThruReply()
     if (myGuide->getTaskID() == "changeDir")
     {
         emit haveCurrentRemoteDir(pendingReply, &pendingParam);
+        emit haveCurrentRemoteDirResult(pendingReply, pendingParam);
         return;
     }
     if (myGuide->getTaskID() == "fullAuth")
@@ -135,11 +149,121 @@ void AgaveTaskReply::invokePassThruReply()
         emit connectionsClosed(pendingReply);
         return;
     }
+    if (myGuide->getTaskID() == "cachedDirListing")
+    {
+        emit haveListingResult(pendingReply, pendingListing);
+        if (isSignalConnected(QMetaMethod::fromSignal(&RemoteDataReply::haveLSReply)))
+        {
+            QList<FileMetaData> fileList = pendingListing.toFileMetaDataList();
+            emit haveLSReply(pendingReply, &fileList);
+        }
+        return;
+    }
+    if (myGuide->getTaskID() == "cachedJobList")
+    {
+        emit haveJobList(pendingReply, &pendingJobList);
+        emit haveJobListResult(pendingReply, pendingJobList);
+        return;
+    }
 
     myManager->forwardAgaveError("Passthru reply not implemented");
     return;
 }
 
+void AgaveTaskReply::processRangeReply(const QByteArray &replyText)
+{
+    int httpStatus = myReplyObject->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    qint64 requestedOffset = taskParamList->value("offset").toLongLong();
+    bool isTail = taskParamList->contains("tail");
+
+    //Content-Range is "bytes first-last/total" for a part, "bytes */total" when out of range
+    QByteArray contentRange = myReplyObject->rawHeader("Content-Range");
+    qint64 rangeStart = -1;
+    qint64 totalSize = -1;
+    int slashPos = contentRange.lastIndexOf('/');
+    if (slashPos >= 0)
+    {
+        bool sizeOK = false;
+        totalSize = contentRange.mid(slashPos + 1).trimmed().toLongLong(&sizeOK);
+        if (!sizeOK) totalSize = -1;
+
+        int dashPos = contentRange.indexOf('-');
+        int spacePos = contentRange.indexOf(' ');
+        if ((spacePos >= 0) && (dashPos > spacePos) && (dashPos < slashPos))
+        {
+            rangeStart = contentRange.mid(spacePos + 1, dashPos - spacePos - 1).toLongLong();
+        }
+    }
+
+    if (isTail)
+    {
+        //Where a tail starts is only known from the reply
+        requestedOffset = (totalSize >= 0) ? qMax(totalSize - replyText.size(), (qint64) 0) : -1;
+    }
+
+    if (httpStatus == 206)
+    {
+        emit haveRangeReply(RequestState::GOOD, replyText, (rangeStart >= 0) ? rangeStart : requestedOffset, totalSize);
+    }
+    else if (httpStatus == 200)
+    {
+        //The server ignored the range and sent the whole file
+        qint64 tailLength = taskParamList->value("tail").toLongLong();
+        if (isTail && (replyText.size() > tailLength))
+        {
+            emit haveRangeReply(RequestState::GOOD, replyText.right(tailLength), replyText.size() - tailLength, replyText.size());
+        }
+        else
+        {
+            emit haveRangeReply(RequestState::GOOD, replyText, 0, replyText.size());
+        }
+    }
+    else if (httpStatus == 416)
+    {
+        //Past the end of the file, or a tail of an empty file
+        emit haveRangeReply(RequestState::GOOD, QByteArray(), isTail ? 0 : requestedOffset, totalSize);
+    }
+    else if (httpStatus == 0)
+    {
+        processNoContactReply(myReplyObject->errorString());
+    }
+    else
+    {
+        qCWarning(agaveReplies, "Range request failed with HTTP status %d", httpStatus);
+        processFailureReply(myReplyObject->errorString());
+    }
+}
+
+bool AgaveTaskReply::processNotModifiedReply()
+{
+    //Same signals as a full reply, with the result parsed the last time
+    if (myGuide->getTaskID() == "dirListing")
+    {
+        FileListing fileListing;
+        if (!myManager->getConditionalCache()->lookupListing(myReplyObject, &fileListing)) return false;
+
+        myManager->cacheListingResult(taskParamList->value("dirPath"), fileListing, taskParamList->contains("prefetch"),
+                                      taskParamList->contains("background"));
+        emit haveListingResult(RequestState::GOOD, fileListing);
+        if (isSignalConnected(QMetaMethod::fromSignal(&RemoteDataReply::haveLSReply)))
+        {
+            QList<FileMetaData> fileList = fileListing.toFileMetaDataList();
+            emit haveLSReply(RequestState::GOOD, &fileList);
+        }
+        return true;
+    }
+    else if (myGuide->getTaskID() == "getJobDetails")
+    {
+        RemoteJobData jobData;
+        if (!myManager->getConditionalCache()->lookupJobDetails(myReplyObject, &jobData)) return false;
+
+        emit haveJobDetails(RequestState::GOOD, &jobData);
+        emit haveJobDetailsResult(RequestState::GOOD, jobData);
+        return true;
+    }
+    return false;
+}
+
 AgaveTaskGuide * AgaveTaskReply::getTaskGuide()
 {
     return myGuide;
@@ -157,7 +281,7 @@ void AgaveTaskReply::processFailureReply(QString errorText)
 
 void AgaveTaskReply::processBadReply(RequestState replyState, QString errorText)
 {
-    qDebug("%s", qPrintable(errorText));
+    qCWarning(agaveReplies, "%s: %s", qPrintable(myGuide->getTaskID()), qPrintable(errorText));
 
     if (myGuide->getTaskID() == "changeDir")
     {
@@ -171,10 +295,12 @@ void AgaveTaskReply::processBadReply(RequestState replyState, QString errorText)
     else if (myGuide->getTaskID() == "dirListing")
     {
         emit haveLSReply(replyState, NULL);
+        emit haveListingResult(replyState, FileListing());
     }
     else if ((myGuide->getTaskID() == "fileUpload") || (myGuide->getTaskID() == "filePipeUpload"))
     {
         emit haveUploadReply(replyState, NULL);
+        emit haveUploadResult(replyState, FileMetaData());
     }
     else if (myGuide->getTaskID() == "fileDelete")
     {
@@ -183,18 +309,22 @@ void AgaveTaskReply::processBadReply(RequestState replyState, QString errorText)
     else if (myGuide->getTaskID() == "newFolder")
     {
         emit haveMkdirReply(replyState, NULL);
+        emit haveMkdirResult(replyState, FileMetaData());
     }
     else if (myGuide->getTaskID() == "renameFile")
     {
         emit haveRenameReply(replyState, NULL);
+        emit haveRenameResult(replyState, FileMetaData());
     }
     else if (myGuide->getTaskID() == "fileMove")
     {
         emit haveMoveReply(replyState, NULL);
+        emit haveMoveResult(replyState, FileMetaData());
     }
     else if (myGuide->getTaskID() == "fileCopy")
     {
         emit haveCopyReply(replyState,NULL);
+        emit haveCopyResult(replyState, FileMetaData());
     }
     else if (myGuide->getTaskID() == "fileDownload")
     {
@@ -203,14 +333,21 @@ void AgaveTaskReply::processBadReply(RequestState replyState, QString errorText)
     else if (myGuide->getTaskID() == "filePipeDownload")
     {
         emit haveBufferDownloadReply(replyState, NULL);
+        emit haveBufferDownloadResult(replyState, QByteArray());
+    }
+    else if (myGuide->getTaskID() == "fileRangeDownload")
+    {
+        emit haveRangeReply(replyState, QByteArray(), -1, -1);
     }
     else if (myGuide->getTaskID() == "getJobList")
     {
         emit haveJobList(replyState, NULL);
+        emit haveJobListResult(replyState, QList<RemoteJobData>());
     }
     else if (myGuide->getTaskID() == "getJobDetails")
     {
         emit haveJobDetails(replyState, NULL);
+        emit haveJobDetailsResult(replyState, RemoteJobData());
     }
     else if (myGuide->getTaskID() == "stopJob")
     {
@@ -223,11 +360,14 @@ void AgaveTaskReply::processBadReply(RequestState replyState, QString errorText)
     else
     {
         emit haveJobReply(replyState, NULL);
+        emit haveJobResult(replyState, QJsonDocument());
     }
 }
 
 void AgaveTaskReply::rawTaskComplete()
 {
+    static const AgaveJSONKeyPath resultPath("result");
+
     this->deleteLater();
 
     if (myGuide->getRequestType() == AgaveRequestType::AGAVE_NONE)
@@ -238,7 +378,7 @@ void AgaveTaskReply::rawTaskComplete()
 
     if ((myManager->inShutdownMode()) && (myGuide->getTaskID() != "authRevoke"))
     {
-        qDebug("Request during shutdown ignored");
+        qCDebug(agaveReplies, "Request during shutdown ignored");
         return;
     }
 
@@ -288,6 +428,21 @@ void AgaveTaskReply::rawTaskComplete()
         //TODO: consider a better way of doing this for larger files
 
         emit haveBufferDownloadReply(RequestState::GOOD, &replyText);
+        emit haveBufferDownloadResult(RequestState::GOOD, replyText);
+        return;
+    }
+    else if (myGuide->getRequestType() == AgaveRequestType::AGAVE_RANGE_DOWNLOAD)
+    {
+        processRangeReply(replyText);
+        return;
+    }
+
+    if (myGuide->isConditional() && AgaveConditionalCache::isNotModified(myReplyObject))
+    {
+        if (!processNotModifiedReply())
+        {
+            processFailureReply("Not modified reply to an unknown request");
+        }
         return;
     }
 
@@ -298,7 +453,7 @@ void AgaveTaskReply::rawTaskComplete()
     {
         if ((int)myReplyObject->error() != 0)
         {
-            qDebug("%d", (int)myReplyObject->error());
+            qCWarning(agaveReplies, "Network error code: %d", (int)myReplyObject->error());
             processFailureReply(myReplyObject->errorString());
         }
         else
@@ -308,17 +463,23 @@ void AgaveTaskReply::rawTaskComplete()
         return;
     }
 
-    qDebug("%s", qPrintable(parseHandler.toJson()));
+    if (!myGuide->isSensitive())
+    {
+        AGAVE_LOG_PAYLOAD("Reply", replyText);
+    }
 
     RequestState prelimResult = standardSuccessFailCheck(myGuide, &parseHandler);
 
+    //A rejected request must not be taken as done, or its result applied to the caches
     if (prelimResult == RequestState::NO_CONNECT)
     {
         processNoContactReply("Missing Status String");
+        return;
     }
     else if (prelimResult == RequestState::FAIL)
     {
         processFailureReply("Request rejected by remote system");
+        return;
     }
 
     if (myGuide->getTaskID() == "authRefresh")
@@ -327,14 +488,24 @@ void AgaveTaskReply::rawTaskComplete()
     }
     else if (myGuide->getTaskID() == "dirListing")
     {
-        QJsonValue expectedArray = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedArray = resultPath.retriveValue(&parseHandler);
         if (!expectedArray.isArray())
         {
             processFailureReply("Parse gives no array for file list.");
             return;
         }
         QJsonArray fileArray = expectedArray.toArray();
+
+        //The older list form is only built if someone is listening for it
+        bool needFileList = isSignalConnected(QMetaMethod::fromSignal(&RemoteDataReply::haveLSReply));
         QList<FileMetaData> fileList;
+        FileListing fileListing;
+        fileListing.reserve(fileArray.size());
+        if (needFileList)
+        {
+            fileList.reserve(fileArray.size());
+        }
+
         for (auto itr = fileArray.constBegin(); itr != fileArray.constEnd(); itr++)
         {
             FileMetaData aFile = parseJSONfileMetaData((*itr).toObject());
@@ -343,86 +514,118 @@ void AgaveTaskReply::rawTaskComplete()
                 processFailureReply("Parse gives invalid array for file list.");
                 return;
             }
-            fileList.append(aFile);
+            fileListing.append(aFile);
+            if (needFileList)
+            {
+                fileList.append(aFile);
+            }
+        }
+        myManager->getConditionalCache()->storeListing(myReplyObject, fileListing);
+        myManager->cacheListingResult(taskParamList->value("dirPath"), fileListing, taskParamList->contains("prefetch"),
+                                      taskParamList->contains("background"));
+        emit haveListingResult(RequestState::GOOD, fileListing);
+        if (needFileList)
+        {
+            emit haveLSReply(RequestState::GOOD, &fileList);
         }
-        emit haveLSReply(RequestState::GOOD, &fileList);
     }
     else if ((myGuide->getTaskID() == "fileUpload") || (myGuide->getTaskID() == "filePipeUpload"))
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         FileMetaData aFile = parseJSONfileMetaData(expectedObject.toObject());
         if (aFile.getFileType() == FileType::INVALID)
         {
             processFailureReply("Invalid file data");
             return;
         }
+        myManager->applyFileOperationResult(this, &aFile);
         emit haveUploadReply(RequestState::GOOD, &aFile);
+        emit haveUploadResult(RequestState::GOOD, aFile);
     }
     else if (myGuide->getTaskID() == "fileDelete")
     {
+        myManager->applyFileOperationResult(this, NULL);
         emit haveDeleteReply(RequestState::GOOD);
     }
     else if (myGuide->getTaskID() == "newFolder")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         FileMetaData aFile = parseJSONfileMetaData(expectedObject.toObject());
         if (aFile.getFileType() == FileType::INVALID)
         {
             processFailureReply("Invalid file data");
             return;
         }
+        myManager->applyFileOperationResult(this, &aFile);
         emit haveMkdirReply(RequestState::GOOD, &aFile);
+        emit haveMkdirResult(RequestState::GOOD, aFile);
     }
     else if (myGuide->getTaskID() == "renameFile")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         FileMetaData aFile = parseJSONfileMetaData(expectedObject.toObject());
         if (aFile.getFileType() == FileType::INVALID)
         {
             processFailureReply("Invalid file data");
             return;
         }
+        myManager->applyFileOperationResult(this, &aFile);
         emit haveRenameReply(RequestState::GOOD, &aFile);
+        emit haveRenameResult(RequestState::GOOD, aFile);
     }
     else if (myGuide->getTaskID() == "fileCopy")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         FileMetaData aFile = parseJSONfileMetaData(expectedObject.toObject());
         if (aFile.getFileType() == FileType::INVALID)
         {
             processFailureReply("Invalid file data");
             return;
         }
+        myManager->applyFileOperationResult(this, &aFile);
         emit haveCopyReply(RequestState::GOOD, &aFile);
+        emit haveCopyResult(RequestState::GOOD, aFile);
     }
     else if (myGuide->getTaskID() == "fileMove")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         FileMetaData aFile = parseJSONfileMetaData(expectedObject.toObject());
         if (aFile.getFileType() == FileType::INVALID)
         {
             processFailureReply("Invalid file data");
             return;
         }
+        myManager->applyFileOperationResult(this, &aFile);
         emit haveMoveReply(RequestState::GOOD, &aFile);
+        emit haveMoveResult(RequestState::GOOD, aFile);
     }
     else if (myGuide->getTaskID() == "getJobList")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
+        //A missing list would otherwise be saved as an empty one
+        if (!expectedObject.isArray())
+        {
+            processFailureReply("Parse gives no array for job list.");
+            return;
+        }
         QList<RemoteJobData> jobList = parseJSONjobMetaData(expectedObject.toArray());
+        myManager->cacheJobListResult(taskParamList->value("jobQuery"), jobList);
 
         emit haveJobList(RequestState::GOOD, &jobList);
+        emit haveJobListResult(RequestState::GOOD, jobList);
     }
     else if (myGuide->getTaskID() == "getJobDetails")
     {
-        QJsonValue expectedObject = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedObject = resultPath.retriveValue(&parseHandler);
         RemoteJobData jobData = parseJSONjobDetails(expectedObject.toObject());
         if (jobData.getState() == "ERROR")
         {
             processFailureReply("Invalid job data");
             return;
         }
+        myManager->getConditionalCache()->storeJobDetails(myReplyObject, jobData);
         emit haveJobDetails(RequestState::GOOD, &jobData);
+        emit haveJobDetailsResult(RequestState::GOOD, jobData);
     }
     else if (myGuide->getTaskID() == "stopJob")
     {
@@ -431,30 +634,43 @@ void AgaveTaskReply::rawTaskComplete()
     else if (myGuide->getTaskID() == "getAgaveList")
     {
         //TODO More error checking here
-        QJsonValue expectedArray = retriveMainAgaveJSON(&parseHandler,"result");
+        QJsonValue expectedArray = resultPath.retriveValue(&parseHandler);
         QJsonArray appList = expectedArray.toArray();
         emit haveAgaveAppList(RequestState::GOOD, &appList);
     }
     else
     {
+        if (myGuide->getTaskID() == "agaveAppStart")
+        {
+            static const AgaveJSONKeyPath jobIDPath({"result", "id"});
+            static const AgaveJSONKeyPath jobStatePath({"result", "status"});
+            QString jobID = jobIDPath.retriveValue(&parseHandler).toString();
+            if (!jobID.isEmpty())
+            {
+                myManager->jobSubmitted(jobID, jobStatePath.retriveValue(&parseHandler).toString());
+            }
+        }
         emit haveJobReply(RequestState::GOOD, &parseHandler);
+        emit haveJobResult(RequestState::GOOD, parseHandler);
     }
 
 }
 
 RequestState AgaveTaskReply::standardSuccessFailCheck(AgaveTaskGuide * taskGuide, QJsonDocument * parsedDoc)
 {
+    static const AgaveJSONKeyPath statusPath("status");
+
     //In Agave TOKEN uses a different output form
     if (taskGuide->isTokenFormat())
     {
-        if (parsedDoc->object().contains("error"))
+        if (parsedDoc->object().contains(QLatin1String("error")))
         {
             return RequestState::FAIL;
         }
     }
     else
     {
-        QString statusString = retriveMainAgaveJSON(parsedDoc,"status").toString();
+        QString statusString = statusPath.retriveValue(parsedDoc).toString();
 
         if (statusString == "error")
         {
@@ -508,9 +724,16 @@ FileMetaData AgaveTaskReply::parseJSONfileMetaData(QJsonObject fileNameValuePair
         ret.setType(FileType::FILE);
     }
     //TODO: consider more validity checks here
-    int fileLength = fileNameValuePairs.value("length").toInt();
+    //JSON numbers are doubles, toInt() would give 0 for files over 2 GB
+    qint64 fileLength = (qint64) fileNameValuePairs.value("length").toDouble();
     ret.setSize(fileLength);
 
+    QJsonValue modifiedValue = fileNameValuePairs.value("lastModified");
+    if (modifiedValue.isString())
+    {
+        ret.setModifiedTime(parseAgaveTime(modifiedValue.toString()));
+    }
+
     return ret;
 }
 
@@ -550,9 +773,9 @@ RemoteJobData AgaveTaskReply::parseJSONjobDetails(QJsonObject rawJobData, bool h
 
     if (haveDetails)
     {
-        QMap<QString, QVariant> inputMap = rawJobData.value("inputs").toObject().toVariantMap();
-        QMap<QString, QVariant> paramMap = rawJobData.value("parameters").toObject().toVariantMap();
-        ret.setDetails(convertVarMapToString(inputMap),convertVarMapToString(paramMap));
+        ret.setDetails(convertJSONobjToStringMap(rawJobData.value("inputs").toObject()),
+                       convertJSONobjToStringMap(rawJobData.value("parameters").toObject()));
+        ret.setArchive(rawJobData.value("archivePath").toString(), rawJobData.value("archiveSystem").toString());
     }
 
     return ret;
@@ -560,14 +783,21 @@ RemoteJobData AgaveTaskReply::parseJSONjobDetails(QJsonObject rawJobData, bool h
 
 QJsonValue AgaveTaskReply::retriveMainAgaveJSON(QJsonDocument * parsedDoc, const char * oneKey)
 {
-    QList<QString> smallList = { oneKey };
-    return retriveMainAgaveJSON(parsedDoc, smallList);
+    return retriveMainAgaveJSON(parsedDoc, QString::fromUtf8(oneKey));
 }
 
 QJsonValue AgaveTaskReply::retriveMainAgaveJSON(QJsonDocument * parsedDoc, QString oneKey)
 {
-    QList<QString> smallList = { oneKey };
-    return retriveMainAgaveJSON(parsedDoc, smallList);
+    //One key needs one lookup, not a key list
+    QJsonValue nullVal;
+    if (parsedDoc->isNull()) return nullVal;
+    if (parsedDoc->isEmpty()) return nullVal;
+    if (!parsedDoc->isObject()) return nullVal;
+
+    QJsonValue resultVal = parsedDoc->object().value(oneKey);
+    if (resultVal.isUndefined()) return nullVal;
+    if (resultVal.isNull()) return nullVal;
+    return resultVal;
 }
 
 QJsonValue AgaveTaskReply::retriveMainAgaveJSON(QJsonDocument * parsedDoc, QList<QString> keyList)
@@ -596,7 +826,6 @@ QJsonValue AgaveTaskReply::recursiveJSONdig(QJsonValue currVal, QList<QString> *
 
     //Get next obj
     if (!currVal.isObject()) return nullValue;
-    if (!currVal.toObject().contains(keyToFind)) return nullValue;
     QJsonValue targetedValue = currVal.toObject().value(keyToFind);
     if (targetedValue.isUndefined()) return nullValue;
 
@@ -608,44 +837,117 @@ QJsonValue AgaveTaskReply::recursiveJSONdig(QJsonValue currVal, QList<QString> *
     return recursiveJSONdig(targetedValue,keyList,i+1);
 }
 
-QDateTime AgaveTaskReply::parseAgaveTime(QString agaveTime)
+static bool readTimeDigits(const QChar *&pos, const QChar * end, int numDigits, int * result)
+{
+    if (end - pos < numDigits) return false;
+    int ret = 0;
+    for (int i = 0; i < numDigits; i++)
+    {
+        ushort digit = pos->unicode() - '0';
+        if (digit > 9) return false;
+        ret = ret * 10 + digit;
+        pos++;
+    }
+    *result = ret;
+    return true;
+}
+
+static bool readTimeSeparator(const QChar *&pos, const QChar * end, char separator)
+{
+    if ((pos == end) || (*pos != QLatin1Char(separator))) return false;
+    pos++;
+    return true;
+}
+
+QDateTime AgaveTaskReply::parseAgaveTime(const QString &agaveTime)
 {
     QDateTime err; //Default obj indicates error
     //2017-03-29T15:14:00.000-05:00
-    QStringList dateAndTime = agaveTime.split('T');
-    if (dateAndTime.size() < 2) return err;
+    //Single pass over the string data, result is given in UTC
+    const QChar * pos = agaveTime.constData();
+    const QChar * end = pos + agaveTime.size();
 
-    QString theDate = dateAndTime.at(0);
-    QString theTime = dateAndTime.at(1);
+    int year, mon, day, hour, min;
+    int sec = 0;
+    int msec = 0;
 
-    QStringList dateParts = theDate.split('-');
-    if (dateParts.size() < 3) return err;
+    if (!readTimeDigits(pos, end, 4, &year)) return err;
+    if (!readTimeSeparator(pos, end, '-')) return err;
+    if (!readTimeDigits(pos, end, 2, &mon)) return err;
+    if (!readTimeSeparator(pos, end, '-')) return err;
+    if (!readTimeDigits(pos, end, 2, &day)) return err;
+    if (!readTimeSeparator(pos, end, 'T') && !readTimeSeparator(pos, end, ' ')) return err;
+    if (!readTimeDigits(pos, end, 2, &hour)) return err;
+    if (!readTimeSeparator(pos, end, ':')) return err;
+    if (!readTimeDigits(pos, end, 2, &min)) return err;
 
-    QStringList timeParts = theTime.split(':');
-    if (timeParts.size() < 3) return err;
+    if (readTimeSeparator(pos, end, ':'))
+    {
+        if (!readTimeDigits(pos, end, 2, &sec)) return err;
+
+        if (readTimeSeparator(pos, end, '.') || readTimeSeparator(pos, end, ','))
+        {
+            //Any number of fraction digits, only milliseconds are kept
+            int numDigits = 0;
+            int digit;
+            while (readTimeDigits(pos, end, 1, &digit))
+            {
+                if (numDigits < 3)
+                {
+                    msec = msec * 10 + digit;
+                }
+                numDigits++;
+            }
+            if (numDigits == 0) return err;
+            for (int i = numDigits; i < 3; i++)
+            {
+                msec = msec * 10;
+            }
+        }
+    }
 
-    QString seconds = timeParts.at(2);
-    seconds.truncate(2);
+    //No offset is taken as UTC
+    int offsetSecs = 0;
+    if (readTimeSeparator(pos, end, 'Z') || readTimeSeparator(pos, end, 'z')) {}
+    else if (pos != end)
+    {
+        int sign;
+        if (readTimeSeparator(pos, end, '+'))
+        {
+            sign = 1;
+        }
+        else if (readTimeSeparator(pos, end, '-'))
+        {
+            sign = -1;
+        }
+        else
+        {
+            return err;
+        }
 
-    bool convOkay;
-    int year = dateParts.at(0).toInt(&convOkay);
-    if (!convOkay) return err;
-    int mon = dateParts.at(1).toInt(&convOkay);
-    if (!convOkay) return err;
-    int day = dateParts.at(2).toInt(&convOkay);
-    if (!convOkay) return err;
+        int offsetHours;
+        int offsetMins = 0;
+        if (!readTimeDigits(pos, end, 2, &offsetHours)) return err;
+        if (pos != end)
+        {
+            readTimeSeparator(pos, end, ':');
+            if (!readTimeDigits(pos, end, 2, &offsetMins)) return err;
+        }
+        if ((offsetHours > 23) || (offsetMins > 59)) return err;
+        offsetSecs = sign * (offsetHours * 3600 + offsetMins * 60);
+    }
 
-    int hour = timeParts.at(0).toInt(&convOkay);
-    if (!convOkay) return err;
-    int min = timeParts.at(1).toInt(&convOkay);
-    if (!convOkay) return err;
-    int sec = seconds.toInt(&convOkay);
-    if (!convOkay) return err;
+    if (pos != end) return err;
 
     QDate realDate(year, mon, day);
-    QTime realTime(hour, min, sec);
+    QTime realTime(hour, min, sec, msec);
+    if (!realDate.isValid() || !realTime.isValid()) return err;
 
-    QDateTime ret(realDate,realTime);
+    QDateTime ret(realDate, realTime, Qt::UTC);
+    if (offsetSecs != 0)
+    {
+        ret = ret.addSecs(-offsetSecs);
+    }
     return ret;
 }
 
@@ -659,3 +961,44 @@ QMap<QString, QString> AgaveTaskReply::convertVarMapToString(QMap<QString, QVari
     }
     return ret;
 }
+
+static QString convertJSONvalToString(const QJsonValue &inVal)
+{
+    switch (inVal.type())
+    {
+    case QJsonValue::String : return inVal.toString();
+    case QJsonValue::Double : return QString::number(inVal.toDouble(), 'g', QLocale::FloatingPointShortest);
+    case QJsonValue::Bool : return inVal.toBool() ? QStringLiteral("true") : QStringLiteral("false");
+    case QJsonValue::Object : return QString::fromUtf8(QJsonDocument(inVal.toObject()).toJson(QJsonDocument::Compact));
+    default : break;
+    }
+    return QString();
+}
+
+QMultiMap<QString, QString> AgaveTaskReply::convertJSONobjToStringMap(const QJsonObject &inObj)
+{
+    //Array values (ie. lists of input files) become one entry per element.
+    //Elements are inserted in reverse so that values(key) gives them in array order.
+    QMultiMap<QString, QString> ret;
+    for (auto itr = inObj.constBegin(); itr != inObj.constEnd(); itr++)
+    {
+        QJsonValue aValue = itr.value();
+        if (!aValue.isArray())
+        {
+            ret.insert(itr.key(), convertJSONvalToString(aValue));
+            continue;
+        }
+
+        QJsonArray valueArray = aValue.toArray();
+        if (valueArray.isEmpty())
+        {
+            ret.insert(itr.key(), QString());
+            continue;
+        }
+        for (int i = valueArray.size() - 1; i >= 0; i--)
+        {
+            ret.insert(itr.key(), convertJSONvalToString(valueArray.at(i)));
+        }
+    }
+    return ret;
+}
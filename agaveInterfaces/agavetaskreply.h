@@ -47,6 +47,8 @@
 #include <QJsonObject>
 #include <QTimer>
 #include <QDateTime>
+#include <QLocale>
+#include <QMetaMethod>
 #include <QStringList>
 #include <QList>
 
@@ -69,6 +71,8 @@ public:
 
     void invokePassThruReply();
     void delayedPassThruReply(RequestState replyState, QString * param1 = NULL);
+    void setPassThruListing(FileListing newListing);
+    void setPassThruJobList(QList<RemoteJobData> newJobList);
 
     AgaveTaskGuide * getTaskGuide();
 
@@ -77,13 +81,15 @@ public:
     static QList<RemoteJobData> parseJSONjobMetaData(QJsonArray rawJobList);
     static RemoteJobData parseJSONjobDetails(QJsonObject rawJobData, bool haveDetails = true);
 
+    //Legacy API, no longer used in this library: use AgaveJSONKeyPath, which does not rebuild the key list on every call
     static QJsonValue retriveMainAgaveJSON(QJsonDocument * parsedDoc, const char * oneKey);
     static QJsonValue retriveMainAgaveJSON(QJsonDocument * parsedDoc, QString oneKey);
     static QJsonValue retriveMainAgaveJSON(QJsonDocument * parsedDoc, QList<QString> keyList);
     static QJsonValue recursiveJSONdig(QJsonValue currObj, QList<QString> * keyList, int i);
 
-    static QDateTime parseAgaveTime(QString agaveTime);
+    static QDateTime parseAgaveTime(const QString &agaveTime);
     static QMap<QString, QString> convertVarMapToString(QMap<QString, QVariant> inMap);
+    static QMultiMap<QString, QString> convertJSONobjToStringMap(const QJsonObject &inObj);
 
 signals:
     //For redirecting info to the Agave handler:
@@ -98,6 +104,8 @@ private:
     void processFailureReply(QString errorText);
 
     void processBadReply(RequestState replyState, QString errorText);
+    bool processNotModifiedReply();
+    void processRangeReply(const QByteArray &replyText);
 
     AgaveHandler * myManager = NULL;
     AgaveTaskReply * passThruRef = NULL;
@@ -107,6 +115,8 @@ private:
     //PassThru reply store:
     RequestState pendingReply;
     QString pendingParam;
+    FileListing pendingListing;
+    QList<RemoteJobData> pendingJobList;
 
     QMultiMap<QString, QString> * taskParamList = NULL;
 };
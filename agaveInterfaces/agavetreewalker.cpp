@@ -0,0 +1,243 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "agavetreewalker.h"
+#include "agavehandler.h"
+#include "agavelistingcache.h"
+#include "agavelogging.h"
+
+#include <QTimer>
+
+AgaveTreeWalker::AgaveTreeWalker(AgaveHandler * theManager, QString rootPath, int maxInFlight) : QObject((QObject *)theManager)
+{
+    myManager = theManager;
+    rootKey = AgaveListingCache::getCacheKey(rootPath);
+    maxInFlightListings = qMax(maxInFlight, 1);
+
+    //Started later, so the caller can connect to the signals first
+    QTimer::singleShot(0, this, SLOT(startWalk()));
+}
+
+void AgaveTreeWalker::setNamePattern(QString wildcardPattern)
+{
+    usePattern = !wildcardPattern.isEmpty();
+    namePattern = QRegularExpression(QRegularExpression::anchoredPattern(QRegularExpression::wildcardToRegularExpression(wildcardPattern)));
+}
+
+void AgaveTreeWalker::setDeleteAfterWalk(bool deleteRoot)
+{
+    deleteAfterWalk = deleteRoot;
+}
+
+QString AgaveTreeWalker::getRootPath()
+{
+    return rootKey;
+}
+
+qint64 AgaveTreeWalker::getTotalBytes()
+{
+    return totalBytes;
+}
+
+int AgaveTreeWalker::getFileCount()
+{
+    return fileCount;
+}
+
+int AgaveTreeWalker::getFolderCount()
+{
+    return folderCount;
+}
+
+void AgaveTreeWalker::startWalk()
+{
+    queueFolder(rootKey, QString());
+    startListings();
+}
+
+void AgaveTreeWalker::gotListing(RequestState replyState, FileListing folderListing)
+{
+    auto itr = inFlightListings.find(QObject::sender());
+    if (itr == inFlightListings.end()) return;
+    QString folderKey = *itr;
+    inFlightListings.erase(itr);
+
+    if (!openFolders.contains(folderKey)) return;
+
+    if (replyState != RequestState::GOOD)
+    {
+        qCWarning(agaveReplies, "Tree walk unable to list %s", qPrintable(folderKey));
+        walkFailed = true;
+        folderDone(folderKey);
+        startListings();
+        return;
+    }
+
+    emit folderListed(folderKey, folderListing);
+
+    //Subfolders are queued after the loop, as adding to openFolders may move its entries
+    QStringList childFolders;
+    qint64 folderBytes = 0;
+    for (auto entryItr = folderListing.constBegin(); entryItr != folderListing.constEnd(); ++entryItr)
+    {
+        FileListingEntry anEntry = *entryItr;
+        QString entryKey = AgaveListingCache::getCacheKey(anEntry.getFullPath());
+        //Agave lists the folder itself as "."
+        if (entryKey == folderKey) continue;
+
+        if (anEntry.getFileType() == FileType::DIR)
+        {
+            if (seenFolders.contains(entryKey)) continue;
+            seenFolders.insert(entryKey);
+            folderCount++;
+            childFolders.append(entryKey);
+        }
+        else
+        {
+            fileCount++;
+            totalBytes += anEntry.getSize();
+            folderBytes += anEntry.getSize();
+        }
+
+        if (!usePattern || namePattern.match(anEntry.getFileName()).hasMatch()
+                || namePattern.match(entryKey.mid(rootKey.size() + 1)).hasMatch())
+        {
+            emit entryFound(anEntry.toFileMetaData());
+        }
+    }
+
+    FolderNode &folderNode = openFolders[folderKey];
+    folderNode.totalBytes += folderBytes;
+    folderNode.pendingFolders += childFolders.size();
+    for (const QString &childKey : childFolders)
+    {
+        queueFolder(childKey, folderKey);
+    }
+
+    if (childFolders.isEmpty())
+    {
+        folderDone(folderKey);
+    }
+    startListings();
+}
+
+void AgaveTreeWalker::gotDelete(RequestState replyState)
+{
+    finishWalk(replyState);
+}
+
+void AgaveTreeWalker::queueFolder(QString folderKey, QString parentKey)
+{
+    seenFolders.insert(folderKey);
+
+    FolderNode newNode;
+    newNode.parentKey = parentKey;
+    newNode.totalBytes = 0;
+    newNode.pendingFolders = 0;
+    openFolders.insert(folderKey, newNode);
+
+    folderQueue.append(folderKey);
+}
+
+void AgaveTreeWalker::startListings()
+{
+    while (!folderQueue.isEmpty() && (inFlightListings.size() < maxInFlightListings))
+    {
+        QString folderKey = folderQueue.takeFirst();
+        //Totals, and whether it is safe to delete, must not come from cached or stored listings
+        RemoteDataReply * listReply = myManager->remoteLSFresh(folderKey);
+        if (listReply == NULL)
+        {
+            walkFailed = true;
+            folderDone(folderKey);
+            continue;
+        }
+        //So the walk does not move prefetch away from what the user is looking at
+        listReply->getTaskParamList()->insert("background", "true");
+        inFlightListings.insert(listReply, folderKey);
+        QObject::connect(listReply, SIGNAL(haveListingResult(RequestState,FileListing)),
+                         this, SLOT(gotListing(RequestState,FileListing)));
+    }
+}
+
+void AgaveTreeWalker::folderDone(QString folderKey)
+{
+    //A folder is done once it and every folder below it are listed, which may finish its parents too
+    while (!folderKey.isEmpty())
+    {
+        FolderNode doneNode = openFolders.take(folderKey);
+        emit folderSize(folderKey, doneNode.totalBytes);
+
+        auto parentItr = openFolders.find(doneNode.parentKey);
+        if (parentItr == openFolders.end()) break;
+        parentItr->totalBytes += doneNode.totalBytes;
+        parentItr->pendingFolders--;
+        if (parentItr->pendingFolders > 0) break;
+        folderKey = doneNode.parentKey;
+    }
+
+    if (!openFolders.isEmpty()) return;
+
+    if (!deleteAfterWalk)
+    {
+        finishWalk(walkFailed ? RequestState::FAIL : RequestState::GOOD);
+        return;
+    }
+    if (walkFailed)
+    {
+        qCWarning(agaveReplies, "Tree walk of %s incomplete, not deleting", qPrintable(rootKey));
+        finishWalk(RequestState::FAIL);
+        return;
+    }
+
+    //Agave deletes a folder and everything in it with one request
+    RemoteDataReply * deleteReply = myManager->deleteFile(rootKey);
+    if (deleteReply == NULL)
+    {
+        finishWalk(RequestState::NO_CONNECT);
+        return;
+    }
+    QObject::connect(deleteReply, SIGNAL(haveDeleteReply(RequestState)),
+                     this, SLOT(gotDelete(RequestState)));
+}
+
+void AgaveTreeWalker::finishWalk(RequestState replyState)
+{
+    if (walkFinished) return;
+    walkFinished = true;
+
+    this->deleteLater();
+    emit walkComplete(replyState, totalBytes, fileCount, folderCount);
+}
@@ -0,0 +1,120 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef AGAVETREEWALKER_H
+#define AGAVETREEWALKER_H
+
+#include "../remotedatainterface.h"
+#include "../filelisting.h"
+#include "../filemetadata.h"
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QRegularExpression>
+
+class AgaveHandler;
+
+//Walks a remote folder tree, listing up to maxInFlight folders at a time
+//Every folder is listed by the remote system, never from the listing cache or metadata store.
+//Each folder found is queued for listing, and entries are signaled as each listing arrives.
+//With a name pattern, only entries matching it (as a wildcard, against the name or the path
+//below the root) are signaled, but the whole tree is still walked.
+//Folder sizes, including everything below them, are signaled once the folder's subtree is walked.
+//With delete set, the root is deleted after a successful walk.
+//The walker starts once control returns to the event loop and deletes itself when complete.
+class AgaveTreeWalker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AgaveTreeWalker(AgaveHandler * theManager, QString rootPath, int maxInFlight = 8);
+
+    void setNamePattern(QString wildcardPattern);
+    void setDeleteAfterWalk(bool deleteRoot);
+
+    QString getRootPath();
+    qint64 getTotalBytes();
+    int getFileCount();
+    int getFolderCount();
+
+signals:
+    void entryFound(FileMetaData anEntry);
+    void folderListed(QString folderPath, FileListing folderListing);
+    void folderSize(QString folderPath, qint64 totalBytes);
+    //For a delete, after the delete reply. Totals are what was found, even if some listings failed
+    void walkComplete(RequestState replyState, qint64 totalBytes, int fileCount, int folderCount);
+
+private slots:
+    void startWalk();
+    void gotListing(RequestState replyState, FileListing folderListing);
+    void gotDelete(RequestState replyState);
+
+private:
+    struct FolderNode
+    {
+        QString parentKey;
+        qint64 totalBytes;
+        int pendingFolders;
+    };
+
+    void queueFolder(QString folderKey, QString parentKey);
+    void startListings();
+    void folderDone(QString folderKey);
+    void finishWalk(RequestState replyState);
+
+    AgaveHandler * myManager = NULL;
+    QString rootKey;
+    int maxInFlightListings;
+
+    QRegularExpression namePattern;
+    bool usePattern = false;
+    bool deleteAfterWalk = false;
+
+    QList<QString> folderQueue;
+    QHash<QObject *, QString> inFlightListings;
+    QHash<QString, FolderNode> openFolders;
+    QSet<QString> seenFolders;
+
+    qint64 totalBytes = 0;
+    int fileCount = 0;
+    int folderCount = 0;
+    bool walkFailed = false;
+    bool walkFinished = false;
+};
+
+#endif // AGAVETREEWALKER_H
@@ -0,0 +1,354 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#include "filelisting.h"
+
+FileListingEntry::FileListingEntry(const FileListingData * listingData, int index)
+{
+    myData = listingData;
+    myIndex = index;
+}
+
+QString FileListingEntry::getFullPath() const
+{
+    QString ret = getContainingPath();
+    ret.append(myData->stringPool.constData() + myData->nameOffsets.at(myIndex), myData->nameLengths.at(myIndex));
+    return ret;
+}
+
+QString FileListingEntry::getFileName() const
+{
+    return myData->stringPool.mid(myData->nameOffsets.at(myIndex), myData->nameLengths.at(myIndex));
+}
+
+QString FileListingEntry::getContainingPath() const
+{
+    int pathIndex = myData->pathIndexes.at(myIndex);
+    return myData->stringPool.mid(myData->pathOffsets.at(pathIndex), myData->pathLengths.at(pathIndex));
+}
+
+QStringView FileListingEntry::getFileNameView() const
+{
+    return QStringView(myData->stringPool.constData() + myData->nameOffsets.at(myIndex), myData->nameLengths.at(myIndex));
+}
+
+bool FileListingEntry::fileNameEquals(const QString &fileName) const
+{
+    int nameLength = myData->nameLengths.at(myIndex);
+    if (nameLength != fileName.size()) return false;
+    return (memcmp(myData->stringPool.constData() + myData->nameOffsets.at(myIndex), fileName.constData(), nameLength * sizeof(QChar)) == 0);
+}
+
+qint64 FileListingEntry::getSize() const
+{
+    return myData->fileSizes.at(myIndex);
+}
+
+FileType FileListingEntry::getFileType() const
+{
+    return myData->fileTypes.at(myIndex);
+}
+
+QString FileListingEntry::getFileTypeString() const
+{
+    return FileMetaData::getFileTypeString(getFileType());
+}
+
+QDateTime FileListingEntry::getModifiedTime() const
+{
+    qint64 modifiedTime = myData->modifiedTimes.at(myIndex);
+    if (modifiedTime == FileListingData::noModifiedTime)
+    {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(modifiedTime, Qt::UTC);
+}
+
+FileMetaData FileListingEntry::toFileMetaData() const
+{
+    FileMetaData ret;
+    ret.setFullFilePath(getFullPath());
+    ret.setType(getFileType());
+    ret.setSize(getSize());
+    ret.setModifiedTime(getModifiedTime());
+    return ret;
+}
+
+FileListing::FileListing() : d(new FileListingData()) {}
+
+void FileListing::reserve(int numEntries, int numPoolChars)
+{
+    d->nameOffsets.reserve(numEntries);
+    d->nameLengths.reserve(numEntries);
+    d->pathIndexes.reserve(numEntries);
+    d->fileTypes.reserve(numEntries);
+    d->fileSizes.reserve(numEntries);
+    d->modifiedTimes.reserve(numEntries);
+
+    if (numPoolChars <= 0)
+    {
+        //Rough guess: file names of about 24 characters
+        numPoolChars = numEntries * 24;
+    }
+    d->stringPool.reserve(numPoolChars);
+}
+
+void FileListing::append(const FileMetaData &aFile)
+{
+    QString containingPath = aFile.getContainingPath();
+
+    //Only compare against the last path added, entries of one listing share their path
+    int pathIndex = d->pathOffsets.size() - 1;
+    if ((pathIndex < 0) || (d->pathLengths.at(pathIndex) != containingPath.size()) ||
+            (memcmp(d->stringPool.constData() + d->pathOffsets.at(pathIndex), containingPath.constData(), containingPath.size() * sizeof(QChar)) != 0))
+    {
+        d->pathOffsets.append(d->stringPool.size());
+        d->pathLengths.append(containingPath.size());
+        d->stringPool.append(containingPath);
+        pathIndex = d->pathOffsets.size() - 1;
+    }
+
+    QString fileName = aFile.getFileName();
+    d->nameOffsets.append(d->stringPool.size());
+    d->nameLengths.append(fileName.size());
+    d->stringPool.append(fileName);
+    d->pathIndexes.append(pathIndex);
+
+    d->fileTypes.append(aFile.getFileType());
+    d->fileSizes.append(aFile.getSize());
+
+    QDateTime modifiedTime = aFile.getModifiedTime();
+    if (modifiedTime.isValid())
+    {
+        d->modifiedTimes.append(modifiedTime.toMSecsSinceEpoch());
+    }
+    else
+    {
+        d->modifiedTimes.append(FileListingData::noModifiedTime);
+    }
+}
+
+int FileListing::size() const
+{
+    return d->nameOffsets.size();
+}
+
+bool FileListing::isEmpty() const
+{
+    return d->nameOffsets.isEmpty();
+}
+
+bool FileListing::operator==(const FileListing &toCompare) const
+{
+    if (d == toCompare.d) return true;
+    if (d->stringPool != toCompare.d->stringPool) return false;
+    if (d->nameLengths != toCompare.d->nameLengths) return false;
+    if (d->pathIndexes != toCompare.d->pathIndexes) return false;
+    if (d->fileTypes != toCompare.d->fileTypes) return false;
+    if (d->fileSizes != toCompare.d->fileSizes) return false;
+    if (d->modifiedTimes != toCompare.d->modifiedTimes) return false;
+    return true;
+}
+
+bool FileListing::operator!=(const FileListing &toCompare) const
+{
+    return !(*this == toCompare);
+}
+
+FileListingEntry FileListing::at(int index) const
+{
+    return FileListingEntry(d.constData(), index);
+}
+
+FileMetaData FileListing::getFileMetaData(int index) const
+{
+    return at(index).toFileMetaData();
+}
+
+QList<FileMetaData> FileListing::toFileMetaDataList() const
+{
+    QList<FileMetaData> ret;
+    ret.reserve(size());
+    for (int i = 0; i < size(); i++)
+    {
+        ret.append(getFileMetaData(i));
+    }
+    return ret;
+}
+
+int FileListing::indexOf(const QString &fileName) const
+{
+    for (int i = 0; i < size(); i++)
+    {
+        if (at(i).fileNameEquals(fileName))
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+FileListing FileListing::withFile(const FileMetaData &aFile) const
+{
+    FileListing ret = copyWithout(indexOf(aFile.getFileName()), 1, aFile.getFullPath().size());
+    ret.append(aFile);
+    return ret;
+}
+
+FileListing FileListing::withoutFile(const QString &fileName) const
+{
+    int fileIndex = indexOf(fileName);
+    if (fileIndex < 0) return *this;
+    return copyWithout(fileIndex, 0, 0);
+}
+
+FileListing FileListing::copyWithout(int skipIndex, int extraEntries, int extraChars) const
+{
+    //The arrays and pool are copied directly, in the same layout append() gives,
+    //so no entry is turned back into a FileMetaData and its path parsed again
+    FileListing ret;
+    ret.reserve(size() + extraEntries, d->stringPool.size() + extraChars);
+    FileListingData * newData = ret.d.data();
+    const QChar * poolData = d->stringPool.constData();
+
+    int lastOldPath = -1;
+    for (int i = 0; i < size(); i++)
+    {
+        if (i == skipIndex) continue;
+
+        int oldPath = d->pathIndexes.at(i);
+        if (oldPath != lastOldPath)
+        {
+            newData->pathOffsets.append(newData->stringPool.size());
+            newData->pathLengths.append(d->pathLengths.at(oldPath));
+            newData->stringPool.append(poolData + d->pathOffsets.at(oldPath), d->pathLengths.at(oldPath));
+            lastOldPath = oldPath;
+        }
+
+        newData->nameOffsets.append(newData->stringPool.size());
+        newData->nameLengths.append(d->nameLengths.at(i));
+        newData->stringPool.append(poolData + d->nameOffsets.at(i), d->nameLengths.at(i));
+        newData->pathIndexes.append(newData->pathOffsets.size() - 1);
+
+        newData->fileTypes.append(d->fileTypes.at(i));
+        newData->fileSizes.append(d->fileSizes.at(i));
+        newData->modifiedTimes.append(d->modifiedTimes.at(i));
+    }
+    return ret;
+}
+
+FileListing::const_iterator FileListing::begin() const
+{
+    return const_iterator(d.constData(), 0);
+}
+
+FileListing::const_iterator FileListing::end() const
+{
+    return const_iterator(d.constData(), size());
+}
+
+FileListing::const_iterator FileListing::constBegin() const
+{
+    return begin();
+}
+
+FileListing::const_iterator FileListing::constEnd() const
+{
+    return end();
+}
+
+FileListing::const_iterator::const_iterator(const FileListingData * listingData, int index)
+{
+    myData = listingData;
+    myIndex = index;
+}
+
+FileListingEntry FileListing::const_iterator::operator*() const
+{
+    return FileListingEntry(myData, myIndex);
+}
+
+FileListing::const_iterator &FileListing::const_iterator::operator++()
+{
+    myIndex++;
+    return *this;
+}
+
+bool FileListing::const_iterator::operator==(const const_iterator &other) const
+{
+    return ((myData == other.myData) && (myIndex == other.myIndex));
+}
+
+bool FileListing::const_iterator::operator!=(const const_iterator &other) const
+{
+    return !(*this == other);
+}
+
+QDataStream &operator<<(QDataStream &out, const FileListing &fileListing)
+{
+    out << (qint32) fileListing.size();
+    for (int i = 0; i < fileListing.size(); i++)
+    {
+        out << fileListing.getFileMetaData(i);
+    }
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, FileListing &fileListing)
+{
+    qint32 numEntries;
+    in >> numEntries;
+
+    fileListing = FileListing();
+    if (in.status() != QDataStream::Ok) return in;
+
+    //Each entry takes at least its path's length, type and size, so a larger count is corrupt
+    const qint64 minEntryBytes = 16;
+    if ((numEntries < 0) || ((in.device() != NULL) && (numEntries > in.device()->bytesAvailable() / minEntryBytes)))
+    {
+        in.setStatus(QDataStream::ReadCorruptData);
+        return in;
+    }
+
+    fileListing.reserve(numEntries);
+    for (qint32 i = 0; i < numEntries; i++)
+    {
+        FileMetaData aFile;
+        in >> aFile;
+        if (in.status() != QDataStream::Ok) break;
+        fileListing.append(aFile);
+    }
+    return in;
+}
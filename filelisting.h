@@ -0,0 +1,157 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+// Written by Peter Sempolinski, for the Natural Hazard Modeling Laboratory, director: Ahsan Kareem, at Notre Dame
+
+#ifndef FILELISTING_H
+#define FILELISTING_H
+
+#include "filemetadata.h"
+
+#include <QSharedData>
+#include <QSharedDataPointer>
+#include <QString>
+#include <QStringView>
+#include <QVector>
+#include <QList>
+#include <QMetaType>
+
+#include <cstring>
+
+//The listing is stored as one string pool for all names and containing paths,
+//plus one array per field, so a listing costs a handful of allocations regardless of size
+class FileListingData : public QSharedData
+{
+public:
+    QString stringPool;
+
+    QVector<int> nameOffsets;
+    QVector<int> nameLengths;
+    QVector<int> pathIndexes;
+
+    QVector<FileType> fileTypes;
+    QVector<qint64> fileSizes;
+    QVector<qint64> modifiedTimes; //msecs since epoch, noModifiedTime if unknown
+
+    //Containing paths are usually the same for every entry, so they are stored once each
+    QVector<int> pathOffsets;
+    QVector<int> pathLengths;
+
+    static const qint64 noModifiedTime = std::numeric_limits<qint64>::min();
+};
+
+//Read-only view of one entry of a FileListing, with the same getters as FileMetaData
+//Only valid while the listing it came from exists
+class FileListingEntry
+{
+public:
+    QString getFullPath() const;
+    QString getFileName() const;
+    QString getContainingPath() const;
+    //The name within the listing's own storage, without a copy
+    QStringView getFileNameView() const;
+    bool fileNameEquals(const QString &fileName) const;
+    qint64 getSize() const;
+    FileType getFileType() const;
+    QString getFileTypeString() const;
+    QDateTime getModifiedTime() const;
+
+    FileMetaData toFileMetaData() const;
+
+private:
+    friend class FileListing;
+    FileListingEntry(const FileListingData * listingData, int index);
+
+    const FileListingData * myData;
+    int myIndex;
+};
+
+//Implicitly shared list of file data, as given by a directory listing
+//Copies are cheap and never modify each other, so one listing can be handed to any number of receivers
+class FileListing
+{
+public:
+    FileListing();
+
+    void reserve(int numEntries, int numPoolChars = 0);
+    void append(const FileMetaData &aFile);
+
+    int size() const;
+    bool isEmpty() const;
+    bool operator==(const FileListing &toCompare) const;
+    bool operator!=(const FileListing &toCompare) const;
+    FileListingEntry at(int index) const;
+    FileMetaData getFileMetaData(int index) const;
+    QList<FileMetaData> toFileMetaDataList() const;
+
+    //Index of the entry with this name, or -1
+    int indexOf(const QString &fileName) const;
+
+    //Copies of this listing with one entry added (replacing any entry of the same name) or removed
+    FileListing withFile(const FileMetaData &aFile) const;
+    FileListing withoutFile(const QString &fileName) const;
+
+    class const_iterator
+    {
+    public:
+        FileListingEntry operator*() const;
+        const_iterator &operator++();
+        bool operator==(const const_iterator &other) const;
+        bool operator!=(const const_iterator &other) const;
+
+    private:
+        friend class FileListing;
+        const_iterator(const FileListingData * listingData, int index);
+
+        const FileListingData * myData;
+        int myIndex;
+    };
+
+    const_iterator begin() const;
+    const_iterator end() const;
+    const_iterator constBegin() const;
+    const_iterator constEnd() const;
+
+private:
+    //Copy of this listing without the entry at skipIndex (none if -1), with room for more entries
+    FileListing copyWithout(int skipIndex, int extraEntries, int extraChars) const;
+
+    QSharedDataPointer<FileListingData> d;
+};
+
+Q_DECLARE_METATYPE(FileListing)
+
+QDataStream &operator<<(QDataStream &out, const FileListing &fileListing);
+QDataStream &operator>>(QDataStream &in, FileListing &fileListing);
+
+#endif // FILELISTING_H
@@ -40,7 +40,7 @@ FileMetaData::FileMetaData()
     //Note: defaults are handled in the class header
 }
 
-bool FileMetaData::operator==(const FileMetaData & toCompare)
+bool FileMetaData::operator==(const FileMetaData & toCompare) const
 {
     if (this->getFileName() != toCompare.getFileName()) return false;
     if (this->getFileType() != toCompare.getFileType()) return false;
@@ -48,45 +48,88 @@ bool FileMetaData::operator==(const FileMetaData & toCompare)
     return true;
 }
 
-void FileMetaData::setFullFilePath(QString fullPath)
+void FileMetaData::setFullFilePath(const QString &fullPath)
 {
-    QStringList pathParts;
-    char divChar;
+    QChar divChar = '\\';
     if (fullPath.contains('/'))
     {
-        pathParts = fullPath.split('/');
         divChar = '/';
     }
-    else
+    const QChar * pathData = fullPath.constData();
+
+    //The file name is the last non-empty part of the path
+    int nameEnd = fullPath.size();
+    while ((nameEnd > 0) && (pathData[nameEnd - 1] == divChar))
+    {
+        nameEnd--;
+    }
+    int nameStart = nameEnd;
+    while ((nameStart > 0) && (pathData[nameStart - 1] != divChar))
     {
-        pathParts = fullPath.split('\\');
-        divChar = '\\';
+        nameStart--;
     }
-    fileName = "";
+    fileName = fullPath.mid(nameStart, nameEnd - nameStart);
 
-    while (fileName.isEmpty())
+    //Containing path has a leading divider and one divider after each name.
+    //Paths from Agave are already in this form, so only copy the leading part if they are not.
+    bool isClean = ((nameStart > 0) && (pathData[0] == divChar));
+    for (int i = 1; isClean && (i < nameStart); i++)
     {
-        if (pathParts.size() == 0)
+        if ((pathData[i] == divChar) && (pathData[i - 1] == divChar))
         {
-            fullContainingPath = "";
-            fullContainingPath = fullContainingPath.append(divChar);
-            fileName = "";
-            return;
+            isClean = false;
         }
-        fileName = pathParts.takeLast();
     }
-    fullContainingPath = divChar;
-    for (auto itr = pathParts.cbegin(); itr != pathParts.cend(); itr++)
+
+    if (isClean)
+    {
+        fullContainingPath = internContainingPath(fullPath.left(nameStart));
+        return;
+    }
+
+    QString cleanedPath;
+    cleanedPath.reserve(nameStart + 1);
+    cleanedPath.append(divChar);
+    for (int i = 0; i < nameStart; i++)
     {
-        if (!(*itr).isEmpty())
+        if (pathData[i] != divChar)
         {
-            fullContainingPath.append(*itr);
-            fullContainingPath.append(divChar);
+            cleanedPath.append(pathData[i]);
         }
+        else if (!cleanedPath.endsWith(divChar))
+        {
+            cleanedPath.append(divChar);
+        }
+    }
+    if (!cleanedPath.endsWith(divChar))
+    {
+        cleanedPath.append(divChar);
+    }
+    fullContainingPath = internContainingPath(cleanedPath);
+}
+
+QString FileMetaData::internContainingPath(const QString &containingPath)
+{
+    static QMutex internLock;
+    static QSet<QString> internedPaths;
+
+    QMutexLocker lock(&internLock);
+    auto itr = internedPaths.constFind(containingPath);
+    if (itr != internedPaths.constEnd())
+    {
+        return *itr;
+    }
+
+    //Dropping the pool does not affect entries which already share a string
+    if (internedPaths.size() >= 4096)
+    {
+        internedPaths.clear();
     }
+    internedPaths.insert(containingPath);
+    return containingPath;
 }
 
-void FileMetaData::setSize(int newSize)
+void FileMetaData::setSize(qint64 newSize)
 {
     fileSize = newSize;
 }
@@ -96,6 +139,16 @@ void FileMetaData::setType(FileType newType)
     myType = newType;
 }
 
+void FileMetaData::setModifiedTime(QDateTime newTime)
+{
+    if (!newTime.isValid())
+    {
+        modifiedTime = noModifiedTime;
+        return;
+    }
+    modifiedTime = newTime.toMSecsSinceEpoch();
+}
+
 QString FileMetaData::getFullPath() const
 {
     QString ret = fullContainingPath;
@@ -113,11 +166,20 @@ QString FileMetaData::getContainingPath() const
     return fullContainingPath;
 }
 
-int FileMetaData::getSize() const
+qint64 FileMetaData::getSize() const
 {
     return fileSize;
 }
 
+QDateTime FileMetaData::getModifiedTime() const
+{
+    if (modifiedTime == noModifiedTime)
+    {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(modifiedTime, Qt::UTC);
+}
+
 FileType FileMetaData::getFileType() const
 {
     return myType;
@@ -125,7 +187,12 @@ FileType FileMetaData::getFileType() const
 
 QString FileMetaData::getFileTypeString() const
 {
-    switch (myType)
+    return getFileTypeString(myType);
+}
+
+QString FileMetaData::getFileTypeString(FileType aType)
+{
+    switch (aType)
     {
     case FileType::DIR : return "Folder";
     case FileType::EMPTY_FOLDER : return "Empty";
@@ -152,25 +219,98 @@ QStringList FileMetaData::getPathNameList(QString fullPath)
     return ret;
 }
 
+static bool isPathSlash(QChar aChar)
+{
+    return ((aChar == '/') || (aChar == '\\'));
+}
+
 QString FileMetaData::cleanPathSlashes(QString fullPath)
 {
-    //TODO: maybe this should work for both types of slashes
+    //Works for both types of slashes, the result always uses '/'
+    QVarLengthArray<QChar, 256> cleanedPath;
+    const QChar * pos = fullPath.constData();
+    const QChar * end = pos + fullPath.size();
 
-    bool isFolder = false;
-    if ((fullPath.at(fullPath.size() - 1)) == '/')
+    while (pos != end)
     {
-        isFolder = true;
+        while ((pos != end) && isPathSlash(*pos)) pos++;
+        if (pos == end) break;
+
+        cleanedPath.append('/');
+        while ((pos != end) && !isPathSlash(*pos))
+        {
+            cleanedPath.append(*pos);
+            pos++;
+        }
     }
-    QStringList fileNameList = FileMetaData::getPathNameList(fullPath);
-    QString ret;
-    if (fileNameList.isEmpty()) return "/";
 
-    for (auto itr = fileNameList.cbegin(); itr != fileNameList.cend(); itr++)
+    if (cleanedPath.isEmpty()) return "/";
+
+    bool isFolder = isPathSlash(fullPath.at(fullPath.size() - 1));
+    if (isFolder){cleanedPath.append('/');}
+    return QString(cleanedPath.constData(), cleanedPath.size());
+}
+
+static void appendCanonicalPath(QVarLengthArray<QChar, 256> &outPath, const QString &inputPath)
+{
+    const QChar * pos = inputPath.constData();
+    const QChar * end = pos + inputPath.size();
+
+    while (pos != end)
     {
-        ret.append("/");
-        ret.append(*itr);
+        while ((pos != end) && isPathSlash(*pos)) pos++;
+        const QChar * nameStart = pos;
+        while ((pos != end) && !isPathSlash(*pos)) pos++;
+        int nameLength = pos - nameStart;
+
+        if (nameLength == 0) continue;
+        if ((nameLength == 1) && (nameStart[0] == '.')) continue;
+        if ((nameLength == 2) && (nameStart[0] == '.') && (nameStart[1] == '.'))
+        {
+            //Drop the last name, ".." at the root stays at the root
+            int newSize = outPath.size();
+            while ((newSize > 0) && (outPath.at(newSize - 1) != '/')) newSize--;
+            if (newSize > 0) newSize--;
+            outPath.resize(newSize);
+            continue;
+        }
+
+        outPath.append('/');
+        outPath.append(nameStart, nameLength);
     }
+}
 
-    if (isFolder){ret.append('/');}
-    return ret;
+QString FileMetaData::canonicalizePath(const QString &basePath, const QString &inputPath)
+{
+    QVarLengthArray<QChar, 256> outPath;
+
+    if (inputPath.isEmpty() || !isPathSlash(inputPath.at(0)))
+    {
+        appendCanonicalPath(outPath, basePath);
+    }
+    appendCanonicalPath(outPath, inputPath);
+
+    return QString(outPath.constData(), outPath.size());
+}
+
+QDataStream &operator<<(QDataStream &out, const FileMetaData &fileData)
+{
+    out << fileData.getFullPath() << (qint32) fileData.getFileType() << fileData.getSize() << fileData.getModifiedTime();
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, FileMetaData &fileData)
+{
+    QString fullPath;
+    qint32 fileType;
+    qint64 fileSize;
+    QDateTime modifiedTime;
+    in >> fullPath >> fileType >> fileSize >> modifiedTime;
+
+    fileData = FileMetaData();
+    fileData.setFullFilePath(fullPath);
+    fileData.setType((FileType) fileType);
+    fileData.setSize(fileSize);
+    fileData.setModifiedTime(modifiedTime);
+    return in;
 }
@@ -40,6 +40,14 @@
 #include <QObject>
 #include <QList>
 #include <QString>
+#include <QDateTime>
+#include <QSet>
+#include <QMutex>
+#include <QMetaType>
+#include <QVarLengthArray>
+#include <QDataStream>
+
+#include <limits>
 
 enum class FileType {FILE, DIR, SIM_LINK, EMPTY_FOLDER, INVALID, UNLOADED}; //Add more as needed
 
@@ -47,28 +55,49 @@ class FileMetaData
 {
 public:
     FileMetaData();
-    bool operator==(const FileMetaData & toCompare);
+    bool operator==(const FileMetaData & toCompare) const;
 
-    void setFullFilePath(QString fullPath);
-    void setSize(int newSize);
+    void setFullFilePath(const QString &fullPath);
+    void setSize(qint64 newSize);
     void setType(FileType newType);
+    void setModifiedTime(QDateTime newTime);
 
     QString getFullPath() const;
     QString getFileName() const;
     QString getContainingPath() const;
-    int getSize() const;
+    qint64 getSize() const;
     FileType getFileType() const;
     QString getFileTypeString() const;
+    QDateTime getModifiedTime() const; //Invalid if not known
+
+    static QString getFileTypeString(FileType aType);
 
     static QStringList getPathNameList(QString fullPath);
     static QString cleanPathSlashes(QString fullPath);
 
+    //Resolves inputPath against basePath (if inputPath is relative), removing ".", ".." and repeated slashes
+    //Either slash is accepted. Gives "/a/b" form, with the root as an empty string.
+    static QString canonicalizePath(const QString &basePath, const QString &inputPath);
+
+    //Gives a copy sharing its data with every other interned copy of the same path
+    static QString internContainingPath(const QString &containingPath);
+
 private:
     //Add more members as needed, all must have reasonable defaults, and be handled in copy constructor
+    //The containing path is interned, so all entries of one listing share the same string data
     QString fullContainingPath; //ie. full path without this files own name
     QString fileName;
-    int fileSize = 0; //in bytes?
+    qint64 fileSize = 0; //in bytes
+    qint64 modifiedTime = noModifiedTime; //msecs since epoch, UTC
     FileType myType = FileType::INVALID;
+
+    static const qint64 noModifiedTime = std::numeric_limits<qint64>::min();
 };
 
+Q_DECLARE_TYPEINFO(FileMetaData, Q_MOVABLE_TYPE);
+Q_DECLARE_METATYPE(FileMetaData)
+
+QDataStream &operator<<(QDataStream &out, const FileMetaData &fileData);
+QDataStream &operator>>(QDataStream &in, FileMetaData &fileData);
+
 #endif // FILEMETADATA_H
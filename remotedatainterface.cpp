@@ -35,6 +35,24 @@
 
 #include "remotedatainterface.h"
 
-RemoteDataInterface::RemoteDataInterface(QObject * parent):QObject(parent) {}
+RemoteDataInterface::RemoteDataInterface(QObject * parent):QObject(parent)
+{
+    //Needed for the by-value result signals to work over queued connections
+    qRegisterMetaType<RequestState>("RequestState");
+    qRegisterMetaType<FileMetaData>("FileMetaData");
+    qRegisterMetaType<FileListing>("FileListing");
+    qRegisterMetaType<RemoteJobData>("RemoteJobData");
+    qRegisterMetaType<QList<RemoteJobData> >("QList<RemoteJobData>");
+}
+
+RemoteDataReply * RemoteDataInterface::readRemoteRange(QString, qint64, qint64)
+{
+    return NULL;
+}
+
+RemoteDataReply * RemoteDataInterface::readRemoteTail(QString, qint64)
+{
+    return NULL;
+}
 
 RemoteDataReply::RemoteDataReply(QObject * parent):QObject(parent) {}
@@ -40,11 +40,20 @@
 #include <QList>
 #include <QString>
 
+#include "filemetadata.h"
+#include "filelisting.h"
+#include "remotejobdata.h"
+
+#include <QByteArray>
+#include <QJsonDocument>
+#include <QMetaType>
+
 //Good means the request was good and
 //Fail means the remote service replied, but did not like the request, for some reason
 //No Connect means that the request did not get thru to the remote service at all
 enum class RequestState {FAIL, GOOD, NO_CONNECT};
 //If RemoteDataReply returned is NULL, then the request was invalid due to internal error
+Q_DECLARE_METATYPE(RequestState)
 
 class RemoteJobData;
 class FileMetaData;
@@ -68,6 +77,8 @@ signals:
 
     void haveAuthReply(RequestState authReply);
     void haveLSReply(RequestState replyState, QList<FileMetaData> * fileDataList);
+    //Same result as haveLSReply, as a shared read-only listing which need not be copied by the reciever
+    void haveListingResult(RequestState replyState, FileListing fileListing);
 
     void haveDeleteReply(RequestState replyState);
     void haveMoveReply(RequestState replyState, FileMetaData * revisedFileData);
@@ -86,6 +97,27 @@ signals:
     void haveJobList(RequestState replyState, QList<RemoteJobData> * jobList);
     void haveJobDetails(RequestState replyState, RemoteJobData * jobData);
     void haveStoppedJob(RequestState replyState);
+
+    //The same results again, passed by value, so queued (cross-thread) connections work.
+    //QString, QByteArray, QJsonDocument and QList are implicitly shared, so recievers share one copy of their data.
+    //FileMetaData and RemoteJobData are plain values, which are copied for each reciever.
+    //On failure, the value is default constructed.
+    void haveCurrentRemoteDirResult(RequestState replyState, QString pwd);
+
+    void haveMoveResult(RequestState replyState, FileMetaData revisedFileData);
+    void haveCopyResult(RequestState replyState, FileMetaData newFileData);
+    void haveRenameResult(RequestState replyState, FileMetaData newFileData);
+    void haveMkdirResult(RequestState replyState, FileMetaData newFolderData);
+    void haveUploadResult(RequestState replyState, FileMetaData newFileData);
+    void haveBufferDownloadResult(RequestState replyState, QByteArray fileBuffer);
+
+    void haveJobResult(RequestState replyState, QJsonDocument rawJobReply);
+    void haveJobListResult(RequestState replyState, QList<RemoteJobData> jobList);
+    void haveJobDetailsResult(RequestState replyState, RemoteJobData jobData);
+
+    //Part of a file: rangeData starts at rangeOffset in the file, totalSize is the file size, -1 if not known
+    //A range starting past the end of the file gives no data, and is not an error
+    void haveRangeReply(RequestState replyState, QByteArray rangeData, qint64 rangeOffset, qint64 totalSize);
 };
 
 class RemoteDataInterface : public QObject
@@ -120,6 +152,12 @@ public:
     virtual RemoteDataReply * uploadBuffer(QString location, QByteArray fileData) = 0;
     virtual RemoteDataReply * downloadFile(QString localDest, QString remoteName) = 0;
     virtual RemoteDataReply * downloadBuffer(QString remoteName) = 0;
+    //Part of a file, for previews without downloading all of it. Both reply with haveRangeReply
+    //Not pure virtual, so existing subclasses still build: by default these are invalid requests (NULL)
+    //Length bytes from offset, or to the end of the file if length is negative. A head preview is offset 0
+    virtual RemoteDataReply * readRemoteRange(QString remoteName, qint64 offset, qint64 length = -1);
+    //The last length bytes of the file, or all of it if it is shorter
+    virtual RemoteDataReply * readRemoteTail(QString remoteName, qint64 length);
 
     virtual RemoteDataReply * runRemoteJob(QString jobName, QMultiMap<QString, QString> jobParameters, QString remoteWorkingDir) = 0;
 
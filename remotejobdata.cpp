@@ -50,27 +50,27 @@ RemoteJobData::RemoteJobData(QString jobID, QString jobName, QString appName, QD
     myCreatedTime = createTime;
 }
 
-QString RemoteJobData::getID()
+QString RemoteJobData::getID() const
 {
     return myID;
 }
 
-QString RemoteJobData::getName()
+QString RemoteJobData::getName() const
 {
     return myName;
 }
 
-QString RemoteJobData::getApp()
+QString RemoteJobData::getApp() const
 {
     return myApp;
 }
 
-QDateTime RemoteJobData::getTimeCreated()
+QDateTime RemoteJobData::getTimeCreated() const
 {
     return myCreatedTime;
 }
 
-QString RemoteJobData::getState()
+QString RemoteJobData::getState() const
 {
     return myState;
 }
@@ -80,18 +80,59 @@ void RemoteJobData::setState(QString newState)
     myState = newState;
 }
 
-QMap<QString, QString> RemoteJobData::getInputs()
+QMultiMap<QString, QString> RemoteJobData::getInputs() const
 {
     return inputList;
 }
 
-QMap<QString, QString> RemoteJobData::getParams()
+QMultiMap<QString, QString> RemoteJobData::getParams() const
 {
     return paramList;
 }
 
-void RemoteJobData::setDetails(QMap<QString, QString> inputs, QMap<QString, QString> params)
+void RemoteJobData::setDetails(QMultiMap<QString, QString> inputs, QMultiMap<QString, QString> params)
 {
     inputList = inputs;
     paramList = params;
 }
+
+QString RemoteJobData::getArchivePath() const
+{
+    return myArchivePath;
+}
+
+QString RemoteJobData::getArchiveSystem() const
+{
+    return myArchiveSystem;
+}
+
+void RemoteJobData::setArchive(QString archivePath, QString archiveSystem)
+{
+    myArchivePath = archivePath;
+    myArchiveSystem = archiveSystem;
+}
+
+QDataStream &operator<<(QDataStream &out, const RemoteJobData &jobData)
+{
+    out << jobData.getID() << jobData.getName() << jobData.getApp() << jobData.getTimeCreated();
+    out << jobData.getState() << jobData.getInputs() << jobData.getParams();
+    out << jobData.getArchivePath() << jobData.getArchiveSystem();
+    return out;
+}
+
+QDataStream &operator>>(QDataStream &in, RemoteJobData &jobData)
+{
+    QString jobID, jobName, appName, jobState, archivePath, archiveSystem;
+    QDateTime createTime;
+    QMultiMap<QString, QString> inputs, params;
+
+    in >> jobID >> jobName >> appName >> createTime;
+    in >> jobState >> inputs >> params;
+    in >> archivePath >> archiveSystem;
+
+    jobData = RemoteJobData(jobID, jobName, appName, createTime);
+    jobData.setState(jobState);
+    jobData.setDetails(inputs, params);
+    jobData.setArchive(archivePath, archiveSystem);
+    return in;
+}
@@ -42,6 +42,9 @@
 #include <QDateTime>
 
 #include <QMap>
+#include <QMultiMap>
+#include <QMetaType>
+#include <QDataStream>
 
 class RemoteJobData
 {
@@ -49,18 +52,24 @@ public:
     RemoteJobData();
     RemoteJobData(QString jobID, QString jobName, QString appName, QDateTime createTime);
 
-    QString getID();
-    QString getName();
-    QString getApp();
+    QString getID() const;
+    QString getName() const;
+    QString getApp() const;
 
-    QDateTime getTimeCreated();
+    QDateTime getTimeCreated() const;
 
-    QString getState();
+    QString getState() const;
     void setState(QString newState);
 
-    QMap<QString, QString> getInputs();
-    QMap<QString, QString> getParams();
-    void setDetails(QMap<QString, QString> inputs, QMap<QString, QString> params);
+    //Inputs or parameters with several values have one entry per value, use values(key) to get them all
+    QMultiMap<QString, QString> getInputs() const;
+    QMultiMap<QString, QString> getParams() const;
+    void setDetails(QMultiMap<QString, QString> inputs, QMultiMap<QString, QString> params);
+
+    //Where the job's outputs are kept once it is done, empty if not known
+    QString getArchivePath() const;
+    QString getArchiveSystem() const;
+    void setArchive(QString archivePath, QString archiveSystem);
 
 private:
     QString myID;
@@ -70,8 +79,16 @@ private:
 
     QDateTime myCreatedTime;
 
-    QMap<QString, QString> inputList;
-    QMap<QString, QString> paramList;
+    QMultiMap<QString, QString> inputList;
+    QMultiMap<QString, QString> paramList;
+
+    QString myArchivePath;
+    QString myArchiveSystem;
 };
 
+Q_DECLARE_METATYPE(RemoteJobData)
+
+QDataStream &operator<<(QDataStream &out, const RemoteJobData &jobData);
+QDataStream &operator>>(QDataStream &in, RemoteJobData &jobData);
+
 #endif // REMOTEJOBDATA_H